@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/LSMFile.hpp>
+#include <iostream>
+#include <random>
+#include <thread>
+
+constexpr size_t MULTIGET_BATCH = 4096;
+
+/**
+ * Insert and lookup throughput of a BTreeFile vs the number of threads. Each round builds a new tree from random keys,
+ * split evenly among the threads, then looks up every key. Appending increasing keys to a tree is compared with
+ * appending to a HeapFile first, random inserts are compared with an LSMFile, and single key lookups with multiGet
+ * over batches of keys.
+ */
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  const char *name = "btree_bench.db";
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+  std::cout << "threads,op,tuples,ms,ops_per_sec" << std::endl;
+  for (const char *op : {"heap_append", "append"}) {
+    std::remove(name);
+    if (op == std::string("append")) {
+      db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+    } else {
+      db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    }
+    auto &file = db::getDatabase().get(name);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+      file.insertTuple({{i, "apple", 1.0}});
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << 1 << ',' << op << ',' << n << ',' << elapsed.count() << ',' << n / elapsed.count() * 1000
+              << std::endl;
+    db::getDatabase().getBufferPool().discardFile(name);
+    db::getDatabase().remove(name);
+  }
+  {
+    // Random inserts into an LSMFile, which only writes sorted runs sequentially
+    std::remove(name);
+    db::getDatabase().add(std::make_unique<db::LSMFile>(name, td, 0));
+    auto &file = dynamic_cast<db::LSMFile &>(db::getDatabase().get(name));
+    auto start = std::chrono::steady_clock::now();
+    for (int key : keys) {
+      file.insertTuple({{key, "apple", 1.0}});
+    }
+    file.flush();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << 1 << ",lsm_insert," << n << ',' << elapsed.count() << ',' << n / elapsed.count() * 1000 << std::endl;
+    db::getDatabase().getBufferPool().discardFile(name);
+    db::getDatabase().remove(name);
+  }
+  for (size_t threads : {1, 2, 4, 8, 16}) {
+    std::remove(name);
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+    auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+
+    auto run = [&](const char *op, auto work) {
+      std::atomic<size_t> count{0};
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+          size_t local = 0;
+          for (size_t i = t; i < keys.size(); i += threads) {
+            local += work(keys[i]);
+          }
+          count += local;
+        });
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << threads << ',' << op << ',' << count << ',' << elapsed.count() << ','
+                << count / elapsed.count() * 1000 << std::endl;
+    };
+    run("insert", [&](int key) {
+      file.insertTuple({{key, "apple", 1.0}});
+      return 1;
+    });
+    run("lookup", [&](int key) { return file.lookup(key).has_value() ? 1 : 0; });
+    if (threads == 1) {
+      // Batches of random keys with a single descent per batch
+      size_t count = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < keys.size(); i += MULTIGET_BATCH) {
+        count += file.multiGet(std::span(keys).subspan(i, std::min(MULTIGET_BATCH, keys.size() - i))).size();
+      }
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << threads << ",multiget," << count << ',' << elapsed.count() << ',' << count / elapsed.count() * 1000
+                << std::endl;
+    }
+
+    db::getDatabase().getBufferPool().discardFile(name);
+    db::getDatabase().remove(name);
+  }
+  std::remove(name);
+}
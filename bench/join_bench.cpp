@@ -0,0 +1,94 @@
+#include <chrono>
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Join.hpp>
+#include <iostream>
+#include <random>
+
+/**
+ * Equality join of two HeapFiles of n tuples each: the hash table of op::Join (naive) vs the radix join with one
+ * thread and with every hardware thread. The time of scanning both files is reported as a baseline (scan). Then, a
+ * HeapFile of n / 1000 tuples is joined with a BTreeFile of the n right tuples, keyed on the join field: lookups in
+ * the tree (index) vs the radix join, which reads the whole tree (small_radix).
+ */
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  int repeat = argc > 2 ? std::stoi(argv[2]) : 3;
+  const char *left_name = "join_bench_left.db";
+  const char *right_name = "join_bench_right.db";
+  const char *small_name = "join_bench_small.db";
+  const char *tree_name = "join_bench_tree.db";
+  for (const char *name : {left_name, right_name, small_name, tree_name}) {
+    std::remove(name);
+  }
+  db::TupleDesc td1({db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::INT}, {"id", "quantity"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(left_name, td1));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(right_name, td2));
+  auto &left = db::getDatabase().get(left_name);
+  auto &right = db::getDatabase().get(right_name);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, n);
+  for (int i = 0; i < n; i++) {
+    left.insertTuple({{dis(gen), i * 0.5}});
+    right.insertTuple({{dis(gen), i}});
+  }
+  db::getDatabase().getBufferPool().flushFile(left_name);
+  db::getDatabase().getBufferPool().flushFile(right_name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(small_name, td1));
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(tree_name, td2, 0, false));
+  auto &small = db::getDatabase().get(small_name);
+  auto &tree = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(tree_name));
+  for (int i = 0; i < n / 1000; i++) {
+    small.insertTuple({{dis(gen), i * 0.5}});
+  }
+  db::getDatabase().getBufferPool().flushFile(small_name);
+  tree.bulkLoad(right);
+
+  db::JoinPredicate pred{"id", db::PredicateOp::EQ, "id"};
+  auto time = [&](const std::string &mode, auto run) {
+    size_t rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+      rows = run();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << mode << ',' << rows << ',' << elapsed.count() / repeat << std::endl;
+  };
+  auto rows = [](db::op::Operator &&op) {
+    size_t count = 0;
+    op.open();
+    while (op.next()) {
+      count++;
+    }
+    op.close();
+    return count;
+  };
+  auto scans = [&] {
+    return std::make_pair(std::make_unique<db::op::Scan>(left), std::make_unique<db::op::Scan>(right));
+  };
+
+  std::cout << "mode,result_rows,ms" << std::endl;
+  time("scan", [&] { return rows(db::op::Scan(left)) + rows(db::op::Scan(right)); });
+  time("naive", [&] {
+    auto [l, r] = scans();
+    return rows(db::op::Join(std::move(l), std::move(r), pred));
+  });
+  time("radix_1", [&] {
+    auto [l, r] = scans();
+    return rows(db::op::RadixJoin(std::move(l), std::move(r), pred, 1));
+  });
+  time("radix_" + std::to_string(std::thread::hardware_concurrency()), [&] {
+    auto [l, r] = scans();
+    return rows(db::op::RadixJoin(std::move(l), std::move(r), pred));
+  });
+  time("index", [&] { return rows(db::op::IndexJoin(std::make_unique<db::op::Scan>(small), tree, pred)); });
+  time("small_radix", [&] {
+    return rows(db::op::RadixJoin(std::make_unique<db::op::Scan>(small), std::make_unique<db::op::Scan>(tree), pred));
+  });
+  for (const char *name : {left_name, right_name, small_name, tree_name}) {
+    db::getDatabase().remove(name);
+    std::remove(name);
+  }
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <db/BTreeFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <iostream>
+#include <random>
+#include <set>
+
+/**
+ * Lookup throughput of a bulk loaded BTreeFile through its index pages vs through a learned index, on uniform, skewed
+ * (log-normal gaps) and clustered (dense runs separated by large gaps) keys. Also reports the size of what locates the
+ * leaves: the index pages of the tree, or the segments of the model.
+ */
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  const char *name = "learned_bench.db";
+  const char *in_name = "learned_bench.in";
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+
+  auto generate = [&](const std::string &distribution) {
+    std::mt19937 gen(42);
+    std::set<int> keys;
+    if (distribution == "uniform") {
+      std::uniform_int_distribution<> dis(0, INT32_MAX);
+      while (keys.size() < static_cast<size_t>(n)) {
+        keys.insert(dis(gen));
+      }
+    } else if (distribution == "skewed") {
+      std::lognormal_distribution<> gap(0, 2);
+      double key = 0;
+      while (keys.size() < static_cast<size_t>(n) && key < INT32_MAX) {
+        key += 1 + gap(gen);
+        keys.insert(static_cast<int>(key));
+      }
+    } else {
+      std::uniform_int_distribution<> length(1, 1000);
+      std::uniform_int_distribution<> gap(1, 100000);
+      int key = 0;
+      while (keys.size() < static_cast<size_t>(n)) {
+        for (int i = length(gen); i > 0; i--) {
+          keys.insert(key++);
+        }
+        key += gap(gen);
+      }
+    }
+    return std::vector<int>(keys.begin(), keys.end());
+  };
+
+  std::cout << "distribution,index,tuples,ms,ops_per_sec,index_bytes" << std::endl;
+  for (const char *distribution : {"uniform", "skewed", "clustered"}) {
+    std::vector<int> keys = generate(distribution);
+    std::remove(in_name);
+    db::getDatabase().add(std::make_unique<db::HeapFile>(in_name, td));
+    auto &in = db::getDatabase().get(in_name);
+    for (int key : keys) {
+      in.insertTuple({{key, "apple", 1.0}});
+    }
+    std::vector<int> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), std::mt19937(7));
+
+    for (const char *index : {"btree", "learned"}) {
+      std::remove(name);
+      db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+      auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+      if (index == std::string("learned")) {
+        file.enableLearnedIndex();
+      }
+      file.bulkLoad(in);
+      size_t leaves = 0;
+      size_t page = 0;
+      for (auto it = file.begin(); it != file.end(); ++it) {
+        leaves += it.page != page;
+        page = it.page;
+      }
+      size_t bytes = file.getLearnedIndex() ? file.getLearnedIndex()->getBytes()
+                                            : (file.getNumPages() - leaves) * db::DEFAULT_PAGE_SIZE;
+
+      size_t count = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int key : probes) {
+        count += file.lookup(key).has_value();
+      }
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << distribution << ',' << index << ',' << count << ',' << elapsed.count() << ','
+                << count / elapsed.count() * 1000 << ',' << bytes << std::endl;
+      db::getDatabase().getBufferPool().discardFile(name);
+      db::getDatabase().remove(name);
+    }
+    db::getDatabase().getBufferPool().discardFile(in_name);
+    db::getDatabase().remove(in_name);
+  }
+  std::remove(name);
+  std::remove(in_name);
+}
@@ -0,0 +1,50 @@
+#include <atomic>
+#include <chrono>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <iostream>
+#include <thread>
+
+/**
+ * Scan throughput of a HeapFile vs the number of threads. Each thread repeatedly claims the next unscanned morsel.
+ */
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  const char *name = "scan_bench.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  for (int i = 0; i < n; i++) {
+    file.insertTuple({{i, "apple", 1.0}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+
+  std::cout << "threads,tuples,ms,tuples_per_sec" << std::endl;
+  for (size_t threads : {1, 2, 4, 8, 16}) {
+    auto morsels = file.partition(threads * 16);
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> count{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+      workers.emplace_back([&] {
+        size_t local = 0;
+        for (size_t m = next++; m < morsels.size(); m = next++) {
+          for (const auto &tuple : morsels[m]) {
+            local += std::get<int>(tuple.get_field(0)) >= 0;
+          }
+        }
+        count += local;
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << threads << ',' << count << ',' << elapsed.count() << ',' << count / elapsed.count() * 1000
+              << std::endl;
+  }
+  db::getDatabase().remove(name);
+  std::remove(name);
+}
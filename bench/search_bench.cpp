@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <db/KeySearch.hpp>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * Nanoseconds per search over the keys of a node with `fill` keys: std::lower_bound vs the search kernels, on a dense
+ * key array (index page) and on keys strided inside 76-byte tuples (leaf page).
+ */
+int main(int argc, char *argv[]) {
+  size_t searches = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  constexpr size_t nodes = 256;
+  constexpr size_t stride = 76;
+  std::mt19937 gen(660);
+  std::uniform_int_distribution<> dis;
+
+  auto time = [&](auto &&search) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sum = 0;
+    for (size_t i = 0; i < searches; i++) {
+      sum += search(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sum == 42) {
+      std::cout << "";
+    }
+    return elapsed.count() / searches;
+  };
+
+  std::cout << "fill,std_dense_ns,kernel_dense_ns,std_strided_ns,kernel_strided_ns" << std::endl;
+  for (size_t fill : {8, 16, 32, 64, 128, 256, 339}) {
+    // many nodes so that searches do not always hit the same cache lines
+    std::vector<std::vector<int>> dense(nodes, std::vector<int>(fill));
+    std::vector<std::vector<uint8_t>> strided(nodes, std::vector<uint8_t>(fill * stride));
+    for (size_t n = 0; n < nodes; n++) {
+      for (auto &k : dense[n]) {
+        k = dis(gen);
+      }
+      std::sort(dense[n].begin(), dense[n].end());
+      for (size_t i = 0; i < fill; i++) {
+        *reinterpret_cast<int *>(strided[n].data() + i * stride) = dense[n][i];
+      }
+    }
+    std::vector<int> probes(searches);
+    for (auto &p : probes) {
+      p = dis(gen);
+    }
+
+    double std_dense = time([&](size_t i) {
+      const auto &keys = dense[i % nodes];
+      return std::lower_bound(keys.begin(), keys.end(), probes[i]) - keys.begin();
+    });
+    double kernel_dense =
+        time([&](size_t i) { return db::search::lower_bound(dense[i % nodes].data(), fill, probes[i]); });
+    double std_strided = time([&](size_t i) {
+      const uint8_t *base = strided[i % nodes].data();
+      size_t lo = 0;
+      size_t hi = fill;
+      while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (*reinterpret_cast<const int *>(base + mid * stride) < probes[i]) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return lo;
+    });
+    double kernel_strided =
+        time([&](size_t i) { return db::search::lower_bound(strided[i % nodes].data(), stride, fill, probes[i]); });
+    std::cout << fill << ',' << std_dense << ',' << kernel_dense << ',' << std_strided << ',' << kernel_strided
+              << std::endl;
+  }
+}
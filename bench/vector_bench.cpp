@@ -0,0 +1,76 @@
+#include <chrono>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Vector.hpp>
+#include <iostream>
+#include <random>
+
+/**
+ * Throughput of the row operators (db::op) vs the vectorized operators (db::vec) reading a HeapFile: a filter with two
+ * predicates, a sum without group and a sum grouped by a CHAR field. The filter is also run with its predicates given
+ * to the row Scan, which evaluates them on the bytes of the pages (row_page).
+ */
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  int repeat = argc > 2 ? std::stoi(argv[2]) : 5;
+  const char *name = "vector_bench.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  const char *names[] = {"apple", "banana", "cherry", "date"};
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(0, n);
+  for (int i = 0; i < n; i++) {
+    file.insertTuple({{dis(gen), names[i % 4], dis(gen) * 0.5}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+
+  std::vector<db::FilterPredicate> pred{{"id", db::PredicateOp::LT, n / 2}, {"price", db::PredicateOp::GE, n / 4.0}};
+  db::Aggregate sum{std::nullopt, db::AggregateOp::SUM, "id"};
+  db::Aggregate grouped{"name", db::AggregateOp::SUM, "price"};
+
+  auto time = [&](const std::string &query, const std::string &mode, auto run) {
+    size_t rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++) {
+      rows = run();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << query << ',' << mode << ',' << rows << ',' << elapsed.count() / repeat << ','
+              << static_cast<double>(n) * repeat / elapsed.count() * 1000 << std::endl;
+  };
+  auto rows = [](db::op::Operator &&op) {
+    size_t count = 0;
+    op.open();
+    while (op.next()) {
+      count++;
+    }
+    op.close();
+    return count;
+  };
+  auto vectors = [](db::vec::Operator &&op) {
+    size_t count = 0;
+    db::vec::Batch batch;
+    op.open();
+    while (op.next(batch)) {
+      count += batch.sel.size();
+    }
+    op.close();
+    return count;
+  };
+
+  std::cout << "query,mode,result_rows,ms,input_rows_per_sec" << std::endl;
+  time("filter", "row", [&] { return rows(db::op::Filter(std::make_unique<db::op::Scan>(file), pred)); });
+  time("filter", "row_page", [&] {
+    return rows(db::op::Filter(std::make_unique<db::op::Scan>(file, std::vector<std::string>{}, pred), pred));
+  });
+  time("filter", "vector", [&] { return vectors(db::vec::Filter(std::make_unique<db::vec::Scan>(file), pred)); });
+  time("sum", "row", [&] { return rows(db::op::Aggregate(std::make_unique<db::op::Scan>(file), sum)); });
+  time("sum", "vector", [&] { return vectors(db::vec::Aggregate(std::make_unique<db::vec::Scan>(file), sum)); });
+  time("grouped_sum", "row", [&] { return rows(db::op::Aggregate(std::make_unique<db::op::Scan>(file), grouped)); });
+  time("grouped_sum", "vector",
+       [&] { return vectors(db::vec::Aggregate(std::make_unique<db::vec::Scan>(file), grouped)); });
+  db::getDatabase().remove(name);
+  std::remove(name);
+}
@@ -1,115 +1,895 @@
+#include <algorithm>
 #include <cstring>
 #include <db/BTreeFile.hpp>
 #include <db/Database.hpp>
 #include <db/IndexPage.hpp>
 #include <db/LeafPage.hpp>
+#include <memory>
+#include <db/Query.hpp>
+#include <db/TempFile.hpp>
+#include <filesystem>
+#include <fstream>
+#include <optional>
 #include <stdexcept>
+#include <type_traits>
 
 using namespace db;
 
-BTreeFile::BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index)
-    : DbFile(name, td), key_index(key_index) {}
+namespace {
+// The fraction of the entries that stay in a rightmost page that fills up with appends
+constexpr double APPEND_SPLIT_FILL = 0.9;
 
-void BTreeFile::insertTuple(const Tuple &t) {
-  std::vector<size_t> path;
+// The number of leaves that multiGet reads into the BufferPool before searching them
+constexpr size_t MULTIGET_PREFETCH = DEFAULT_NUM_PAGES / 8;
+
+// The smallest number of keys a Bloom filter is sized for, so that a small tree is not rebuilt on every few inserts
+constexpr size_t MIN_BLOOM_KEYS = 1024;
+
+std::string bloomPath(const std::string &name) { return name + ".bloom"; }
+} // namespace
+
+template <class K>
+BasicBTreeFile<K>::BasicBTreeFile(const std::string &name, const TupleDesc &td, const K &codec, bool unique)
+    : DbFile(name, td), codec(codec), unique(unique) {
+  if (numPages == 1) {
+    // A filter left by an earlier file with the same name does not describe this one
+    std::filesystem::remove(bloomPath(name));
+    return;
+  }
+  std::ifstream in(bloomPath(name), std::ios::binary);
+  size_t header[2];
+  if (!in.read(reinterpret_cast<char *>(header), sizeof(header))) {
+    return;
+  }
+  std::vector<uint8_t> blocks(std::filesystem::file_size(bloomPath(name)) - sizeof(header));
+  if (!in.read(reinterpret_cast<char *>(blocks.data()), static_cast<std::streamsize>(blocks.size()))) {
+    return;
+  }
+  bloom_bits_per_key = header[0];
+  bloom_capacity = header[1];
+  bloom = std::make_unique<BloomFilter>(blocks.data(), blocks.size());
+  bloom_saved = true;
+}
+
+template <class K> BasicBTreeFile<K>::~BasicBTreeFile() { saveBloomFilter(); }
+
+template <class K> void BasicBTreeFile<K>::saveBloomFilter() const {
+  if (!bloom) {
+    return;
+  }
+  // The file is written directly: the BufferPool may already be destroyed with the Database
+  std::ofstream out(bloomPath(name), std::ios::binary | std::ios::trunc);
+  size_t header[2] = {bloom_bits_per_key, bloom_capacity};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(bloom->data()), static_cast<std::streamsize>(bloom->size()));
+}
+
+template <class K> void BasicBTreeFile<K>::enableBloomFilter(size_t bits_per_key) {
+  if (bits_per_key == 0) {
+    throw std::logic_error("A Bloom filter needs at least one bit per key");
+  }
+  std::unique_lock lock(tree_latch);
+  bloom_bits_per_key = bits_per_key;
+  buildBloomFilter();
+}
+
+template <class K> void BasicBTreeFile<K>::buildBloomFilter() {
   BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, root_id};
+  std::vector<uint64_t> hashes;
+  for (size_t id = begin().page; id != 0;) {
+    PageGuard guard(bufferPool, {name, id});
+    BasicLeafPage<K> leaf(guard.page, td, codec);
+    for (size_t slot = 0; slot < leaf.header->size; slot++) {
+      hashes.push_back(BloomFilter::hash(leaf.getKey(slot)));
+    }
+    id = leaf.header->next_leaf;
+  }
+  buildBloomFilter(hashes);
+}
 
-  Page &root_page = bufferPool.getPage(pid);
-  IndexPage root(root_page);
-  if (root.header->size == 0 && root.children[0] != 1) {
-    bufferPool.markDirty({name, root_id});
-    pid.page = numPages++;
-    root.children[0] = pid.page;
+template <class K> void BasicBTreeFile<K>::buildBloomFilter(const std::vector<uint64_t> &hashes) {
+  bloom_capacity = std::max(2 * hashes.size(), MIN_BLOOM_KEYS);
+  bloom = std::make_unique<BloomFilter>(bloom_capacity, bloom_bits_per_key);
+  for (uint64_t hash : hashes) {
+    bloom->insert(hash);
+  }
+  bloom_keys = hashes.size();
+  bloom_full = false;
+}
+
+template <class K> bool BasicBTreeFile<K>::mayContain(const key_type &key) const {
+  return !bloom || bloom_stats.count(bloom->mayContain(BloomFilter::hash(key)));
+}
+
+template <class K> void BasicBTreeFile<K>::missed() const {
+  if (bloom) {
+    bloom_stats.addFalsePositive();
+  }
+}
+
+template <class K> void BasicBTreeFile<K>::enableLearnedIndex(size_t max_error) {
+  if constexpr (std::is_same_v<key_type, int>) {
+    std::unique_lock lock(tree_latch);
+    learned_error = max_error;
+    if (numPages == 1) {
+      return;
+    }
+    // Check that the leaves are laid out as bulkLoad writes them while adding their keys to the model
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    auto model = std::make_unique<LearnedIndex>(max_error);
+    size_t first_leaf = begin().page;
+    size_t fill = 0;
+    size_t positions = 0;
+    int prev = 0;
+    for (size_t id = first_leaf; id != 0;) {
+      PageGuard guard(bufferPool, {name, id});
+      BasicLeafPage<K> leaf(guard.page, td, codec);
+      if (fill == 0) {
+        fill = leaf.header->size;
+      }
+      size_t size = leaf.header->size;
+      if (fill == 0 || id != first_leaf + positions / fill || size > fill ||
+          (size < fill && leaf.header->next_leaf != 0)) {
+        throw std::logic_error("The leaves were modified after bulkLoad");
+      }
+      for (size_t slot = 0; slot < size; slot++) {
+        int key = leaf.getKey(slot);
+        if (positions == 0 || key != prev) {
+          model->add(key, positions);
+        }
+        prev = key;
+        positions++;
+      }
+      id = leaf.header->next_leaf;
+    }
+    if (positions == 0) {
+      return;
+    }
+    model->finish(positions);
+    learned = std::move(model);
+    learned_leaf = first_leaf;
+    learned_fill = fill;
   } else {
+    throw std::logic_error("A learned index needs an int key");
+  }
+}
+
+template <class K> const LearnedIndex *BasicBTreeFile<K>::getLearnedIndex() const { return learned.get(); }
+
+template <class K>
+size_t BasicBTreeFile<K>::seekLearned(std::optional<LatchGuard> &guard, size_t &id, const key_type &key) const {
+  if constexpr (std::is_same_v<key_type, int>) {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    auto [lo, hi] = learned->search(key);
+    // Start from the leaf of the predicted position, which is within the error of the actual position, and only read
+    // the leaves before it if the key is before its first key
+    size_t pos = (lo + hi - 1) / 2;
     while (true) {
-      Page &page = bufferPool.getPage(pid);
-      IndexPage node(page);
-      auto pos = std::lower_bound(node.keys, node.keys + node.header->size, std::get<int>(t.get_field(key_index)));
-      auto slot = pos - node.keys;
-      pid.page = node.children[slot];
-      if (!node.header->index_children) {
+      id = learned_leaf + pos / learned_fill;
+      guard.emplace(bufferPool, PageId{name, id}, false);
+      size_t start = pos - pos % learned_fill;
+      int first = BasicLeafPage<K>(guard->page, td, codec).getKey(0);
+      if (start <= lo || key > first || (unique && key == first)) {
+        pos = std::max(lo, start);
         break;
       }
-      path.push_back(pid.page);
+      pos = start - 1;
+    }
+    while (true) {
+      BasicLeafPage<K> leaf(guard->page, td, codec);
+      size_t from = pos % learned_fill;
+      size_t size = leaf.header->size;
+      size_t to = hi > pos ? std::min(size, from + hi - pos) : size;
+      size_t slot = leaf.lower_bound(key, from, to);
+      if (slot < to || (to == size && leaf.header->next_leaf == 0)) {
+        return slot;
+      }
+      // The key is in the next leaf, or after a run of duplicates longer than the error of the model
+      pos += slot - from;
+      id = learned_leaf + pos / learned_fill;
+      guard.emplace(bufferPool, PageId{name, id}, false);
     }
+  } else {
+    throw std::logic_error("A learned index needs an int key");
+  }
+}
+
+template <class K> std::optional<BloomStats> BasicBTreeFile<K>::getBloomStats() const {
+  if (!bloom) {
+    return std::nullopt;
   }
+  return bloom_stats.get();
+}
 
-  Page &page = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
-  LeafPage leaf(page, td, key_index);
-  if (!leaf.insertTuple(t)) {
+template <class K> size_t BasicBTreeFile<K>::allocatePage() {
+  std::lock_guard lock(alloc_mutex);
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, root_id});
+  BasicIndexPage<K> root(root_guard.page, codec);
+  size_t id = root.header->free_page;
+  if (id == 0) {
+    return numPages++;
+  }
+  PageGuard guard(bufferPool, {name, id});
+  bufferPool.markDirty({name, root_id});
+  bufferPool.markDirty({name, id});
+  root.header->free_page = *reinterpret_cast<size_t *>(guard.page.data());
+  guard.page.fill(0);
+  return id;
+}
+
+template <class K> void BasicBTreeFile<K>::freePage(size_t id) {
+  std::lock_guard lock(alloc_mutex);
+  for (auto &page : rightmost) {
+    size_t expected = id;
+    page.compare_exchange_strong(expected, 0);
+  }
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, root_id});
+  PageGuard guard(bufferPool, {name, id});
+  bufferPool.markDirty({name, root_id});
+  bufferPool.markDirty({name, id});
+  BasicIndexPage<K> root(root_guard.page, codec);
+  guard.page.fill(0);
+  *reinterpret_cast<size_t *>(guard.page.data()) = root.header->free_page;
+  root.header->free_page = id;
+}
+
+template <class K> void BasicBTreeFile<K>::insertTuple(const Tuple &t) {
+  if (learned) {
+    throw std::logic_error("BTreeFile with a learned index is read-only");
+  }
+  if (bloom_full) {
+    std::unique_lock lock(tree_latch);
+    if (bloom_full) {
+      buildBloomFilter();
+    }
+  }
+  if (bloom_saved) {
+    // The written filter would miss this key once its leaf reaches disk
+    std::unique_lock lock(tree_latch);
+    if (bloom_saved) {
+      std::filesystem::remove(bloomPath(name));
+      bloom_saved = false;
+    }
+  }
+  std::shared_lock lock(tree_latch);
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  key_type key = codec.extract(t);
+  if (bloom) {
+    // The key is added before the leaf, so a concurrent lookup that finds it in the leaf also passes the filter
+    bloom->insert(BloomFilter::hash(key));
+    if (++bloom_keys > bloom_capacity) {
+      bloom_full = true;
+    }
+  }
+
+  std::optional<LatchGuard> guard;
+  size_t id = latchRightmost(guard, 0, key);
+  if (!guard) {
+    id = findLeaf(key);
+    while (id == root_id) {
+      // The tree is empty: give the root its first leaf, unless another thread did it first
+      {
+        LatchGuard root_guard(bufferPool, {name, root_id}, true);
+        BasicIndexPage<K> root(root_guard.page, codec);
+        if (root.header->level == 0) {
+          bufferPool.markDirty({name, root_id});
+          root.header->level = 1;
+          root.children[0] = allocatePage();
+        }
+      }
+      id = findLeaf(key);
+    }
+    latchLeaf(guard, id, key, true);
+  }
+
+  bufferPool.markDirty({name, id});
+  BasicLeafPage<K> leaf(guard->page, td, codec);
+  bool last = leaf.header->next_leaf == 0;
+  if (last) {
+    rightmost[0] = id;
+  }
+  if (!leaf.insertTuple(t, unique)) {
+    return;
+  }
+  bool append = last && leaf.getKey(leaf.header->size - 1) == key;
+
+  // The new leaf is not reachable until it is linked from the old one, so it can be filled before latching anything else
+  size_t new_id = allocatePage();
+  key_type new_key;
+  {
+    LatchGuard new_guard(bufferPool, {name, new_id}, true);
+    bufferPool.markDirty({name, new_id});
+    BasicLeafPage<K> new_leaf(new_guard.page, td, codec);
+    new_key = leaf.split(new_leaf, append ? APPEND_SPLIT_FILL : 0.5);
+    leaf.header->next_leaf = new_id;
+    if (last) {
+      rightmost[0] = new_id;
+    }
+  }
+  insertSeparator(new_key, id, new_id, 1, guard);
+}
+
+template <class K>
+void BasicBTreeFile<K>::insertSeparator(key_type key, size_t left, size_t child, uint8_t level,
+                                        std::optional<LatchGuard> &held) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  // The separator goes right after the page that was split, in the page that holds it. The split page stays latched
+  // until then, so that it cannot be split again and put another page between itself and `child`.
+  auto find_left = [&](const BasicIndexPage<K> &node) {
+    return std::find(node.children, node.children + node.header->size + 1, left) - node.children;
+  };
+  std::optional<LatchGuard> guard;
+  size_t id = latchRightmost(guard, level, key);
+  if (guard && find_left(BasicIndexPage<K>(guard->page, codec)) > BasicIndexPage<K>(guard->page, codec).header->size) {
+    guard.reset();
+  }
+  if (!guard) {
+    id = descend(key, level, true);
+  }
+  while (!guard) {
+    guard.emplace(bufferPool, PageId{name, id}, true);
+    BasicIndexPage<K> node(guard->page, codec);
+    if (node.header->level != level) {
+      // The root was split after it was found
+      guard.reset();
+      id = descend(key, level, true);
+    } else if (find_left(node) > node.header->size) {
+      // The page was split after it was found, or the separator of `left` itself is not inserted yet
+      id = node.header->right;
+      guard.reset();
+    }
+  }
+  held.reset();
+
+  bufferPool.markDirty({name, id});
+  BasicIndexPage<K> node(guard->page, codec);
+  size_t slot = find_left(node);
+  bool last = node.header->right == 0;
+  if (last && id != root_id && level < rightmost.size()) {
+    rightmost[level] = id;
+  }
+  double fill = last && slot == node.header->size ? APPEND_SPLIT_FILL : 0.5;
+  if (!node.insertAt(slot, key, child)) {
+    return;
+  }
+  if (id == root_id) {
+    splitRoot(guard->page, fill);
     return;
   }
 
-  pid.page = numPages++;
-  Page &new_leaf_page = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
-  LeafPage new_leaf(new_leaf_page, td, key_index);
-  int new_key = leaf.split(new_leaf);
-  leaf.header->next_leaf = pid.page;
-  size_t new_child = pid.page;
+  size_t new_id = allocatePage();
+  {
+    LatchGuard new_guard(bufferPool, {name, new_id}, true);
+    bufferPool.markDirty({name, new_id});
+    BasicIndexPage<K> new_node(new_guard.page, codec);
+    key = node.split(new_node, fill);
+    node.header->right = new_id;
+    if (last && level < rightmost.size()) {
+      rightmost[level] = new_id;
+    }
+  }
+  insertSeparator(key, id, new_id, level + 1, guard);
+}
+
+template <class K>
+size_t BasicBTreeFile<K>::latchRightmost(std::optional<LatchGuard> &guard, uint8_t level, const key_type &key) {
+  size_t id = level < rightmost.size() ? rightmost[level].load() : 0;
+  if (id == 0) {
+    return id;
+  }
+  // The cached page may have been split since, so check that it is still the rightmost page and that the key is not
+  // smaller than its first key
+  guard.emplace(getDatabase().getBufferPool(), PageId{name, id}, true);
+  if (level == 0) {
+    BasicLeafPage<K> leaf(guard->page, td, codec);
+    if (leaf.header->next_leaf != 0 || leaf.header->size == 0 || key < leaf.getKey(0)) {
+      guard.reset();
+    }
+  } else {
+    BasicIndexPage<K> node(guard->page, codec);
+    if (node.header->level != level || node.header->right != 0 || node.header->size == 0 || key < node.getKey(0)) {
+      guard.reset();
+    }
+  }
+  return id;
+}
 
-  while (!path.empty()) {
+template <class K> void BasicBTreeFile<K>::splitRoot(Page &root_page, double fill) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  size_t left_id = allocatePage();
+  size_t right_id = allocatePage();
+  LatchGuard left_guard(bufferPool, {name, left_id}, true);
+  LatchGuard right_guard(bufferPool, {name, right_id}, true);
+  bufferPool.markDirty({name, left_id});
+  bufferPool.markDirty({name, right_id});
+
+  {
+    // The free list head in the root is protected by alloc_mutex rather than by the latch of the root
+    std::lock_guard lock(alloc_mutex);
+    left_guard.page = root_page;
+  }
+  BasicIndexPage<K> root(root_page, codec);
+  BasicIndexPage<K> left(left_guard.page, codec);
+  BasicIndexPage<K> right(right_guard.page, codec);
+  left.header->free_page = 0;
+  key_type key = left.split(right, fill);
+  left.header->right = right_id;
+  if (root.header->level < rightmost.size()) {
+    rightmost[root.header->level] = right_id;
+  }
+
+  root.header->size = 1;
+  root.header->index_children = true;
+  root.header->level++;
+  root.setKey(0, key);
+  root.children[0] = left_id;
+  root.children[1] = right_id;
+}
+
+template <class K> std::optional<Tuple> BasicBTreeFile<K>::lookup(const key_type &key) const {
+  std::shared_lock lock(tree_latch);
+  if (!mayContain(key)) {
+    return std::nullopt;
+  }
+  std::optional<LatchGuard> guard;
+  size_t id;
+  size_t slot = seek(guard, id, key);
+  if (!guard) {
+    missed();
+    return std::nullopt;
+  }
+  BasicLeafPage<K> leaf(guard->page, td, codec);
+  if (slot == leaf.header->size || leaf.getKey(slot) != key) {
+    missed();
+    return std::nullopt;
+  }
+  return leaf.getTuple(slot);
+}
+
+template <class K> std::vector<Tuple> BasicBTreeFile<K>::multiGet(std::span<const key_type> keys) const {
+  std::shared_lock lock(tree_latch);
+  std::vector<key_type> sorted;
+  sorted.reserve(keys.size());
+  std::copy_if(keys.begin(), keys.end(), std::back_inserter(sorted), [&](const key_type &key) { return mayContain(key); });
+  std::sort(sorted.begin(), sorted.end());
+  sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+  std::vector<Tuple> out;
+  probeNode(root_id, sorted, out);
+  return out;
+}
+
+template <class K>
+void BasicBTreeFile<K>::probeNode(size_t id, std::span<const key_type> keys, std::vector<Tuple> &out) const {
+  bool lower = !unique;
+  std::vector<std::pair<size_t, std::span<const key_type>>> children;
+  size_t right;
+  bool leaves;
+  size_t n = 0;
+  {
+    LatchGuard guard(getDatabase().getBufferPool(), {name, id}, false);
+    BasicIndexPage<K> node(guard.page, codec);
+    if (node.header->level == 0) {
+      // Empty tree
+      return;
+    }
+    leaves = !node.header->index_children;
+    right = node.header->right;
+    while (n < keys.size() && !node.pastHighKey(keys[n], lower)) {
+      // One binary search per child; the following keys of the child are only compared to its upper separator
+      size_t pos = lower ? node.lower_bound(keys[n]) : node.upper_bound(keys[n]);
+      size_t first = n++;
+      while (n < keys.size() && !node.pastHighKey(keys[n], lower) &&
+             (pos == node.header->size || codec.compare(keys[n], node.keys + pos * codec.stride()) < (lower ? 1 : 0))) {
+        n++;
+      }
+      children.emplace_back(node.children[pos], keys.subspan(first, n - first));
+    }
+  }
+  if (leaves) {
+    probeLeaves(children, out);
+  } else {
+    for (const auto &[child, child_keys] : children) {
+      probeNode(child, child_keys, out);
+    }
+  }
+  if (n < keys.size()) {
+    // The page split after its parent was read; the rest of the keys are to its right
+    probeNode(right, keys.subspan(n), out);
+  }
+}
+
+template <class K>
+void BasicBTreeFile<K>::probeLeaves(const std::vector<std::pair<size_t, std::span<const key_type>>> &leaves,
+                                    std::vector<Tuple> &out) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  bool lower = !unique;
+  std::optional<LatchGuard> guard;
+  std::optional<BasicLeafPage<K>> leaf;
+  size_t latched = root_id;
+  auto latch = [&](size_t id) {
+    if (latched != id) {
+      guard.emplace(bufferPool, PageId{name, id}, false);
+      leaf.emplace(guard->page, td, codec);
+      latched = id;
+    }
+  };
+  for (size_t i = 0; i < leaves.size(); i++) {
+    if (i % MULTIGET_PREFETCH == 0) {
+      std::vector<size_t> ids;
+      for (size_t j = i; j < std::min(i + MULTIGET_PREFETCH, leaves.size()); j++) {
+        ids.push_back(leaves[j].first);
+      }
+      std::sort(ids.begin(), ids.end());
+      for (size_t id : ids) {
+        bufferPool.getPage({name, id});
+      }
+    }
+    size_t id = leaves[i].first;
+    for (const key_type &key : leaves[i].second) {
+      latch(id);
+      while (leaf->pastHighKey(key, lower)) {
+        id = leaf->header->next_leaf;
+        latch(id);
+      }
+      // With duplicate keys, the tuples of a key may continue in the following leaves
+      size_t slot = leaf->lower_bound(key);
+      while (true) {
+        if (slot == leaf->header->size) {
+          if (unique || leaf->header->next_leaf == 0) {
+            break;
+          }
+          id = leaf->header->next_leaf;
+          latch(id);
+          slot = 0;
+          continue;
+        }
+        if (leaf->getKey(slot) != key) {
+          break;
+        }
+        out.push_back(leaf->getTuple(slot++));
+      }
+    }
+  }
+}
+
+template <class K> void BasicBTreeFile<K>::bulkLoad(const DbFile &in, double fill_factor) {
+  if (fill_factor <= 0 || fill_factor > 1) {
+    throw std::logic_error("Fill factor out of range");
+  }
+  if (numPages > 1) {
+    throw std::logic_error("BTreeFile is not empty");
+  }
+  bool sorted = true;
+  std::optional<key_type> prev;
+  for (const auto &t : in) {
+    key_type key = codec.extract(t);
+    if (prev && key < *prev) {
+      sorted = false;
+      break;
+    }
+    prev = key;
+  }
+  if (sorted) {
+    load(in, fill_factor);
+    return;
+  }
+  // The sort is stable, so sorting by each key field from the least to the most significant sorts by the whole key
+  std::vector<std::unique_ptr<TempFile>> runs;
+  const DbFile *sorted_in = &in;
+  for (size_t i = codec.count(); i-- > 0;) {
+    runs.push_back(std::make_unique<TempFile>(name + ".sorted", td));
+    db::sort(*sorted_in, runs.back()->file(), td.name_of(codec.field(i)));
+    sorted_in = &runs.back()->file();
+  }
+  load(*sorted_in, fill_factor);
+}
+
+template <class K> void BasicBTreeFile<K>::load(const DbFile &in, double fill_factor) {
+  // The root may be cached from an earlier lookup; every page is written directly to the file below
+  getDatabase().getBufferPool().discardFile(name);
+
+  // A page that reaches its capacity is split, so packed pages keep at most capacity - 1 entries
+  std::vector<std::pair<key_type, size_t>> level;
+  std::vector<uint64_t> hashes;
+  Page page{};
+  BasicLeafPage<K> leaf(page, td, codec);
+  size_t leaf_fill = std::max<size_t>(1, (leaf.capacity - 1) * fill_factor);
+  // Every leaf but the last holds exactly `leaf_fill` tuples, so the position of a tuple is known from its leaf and slot
+  std::unique_ptr<LearnedIndex> model;
+  if (learned_error) {
+    model = std::make_unique<LearnedIndex>(*learned_error);
+  }
+  size_t first_leaf = numPages;
+  size_t positions = 0;
+  key_type prev{};
+  for (const auto &t : in) {
+    key_type key = codec.extract(t);
+    if (bloom) {
+      hashes.push_back(BloomFilter::hash(key));
+    }
+    bool replace = unique && leaf.header->size > 0 && leaf.getKey(leaf.header->size - 1) == key;
+    if (!replace && leaf.header->size == leaf_fill) {
+      leaf.header->next_leaf = numPages + 1;
+      leaf.setHighKey(key);
+      writePage(page, numPages++);
+      page.fill(0);
+    }
+    if (leaf.header->size == 0) {
+      level.emplace_back(key, numPages);
+    }
+    if constexpr (std::is_same_v<key_type, int>) {
+      if (model && (positions == 0 || key != prev)) {
+        model->add(key, positions);
+      }
+    }
+    prev = key;
+    positions += !replace;
+    leaf.insertTuple(t, unique);
+  }
+  if (level.empty()) {
+    return;
+  }
+  leaf.header->next_leaf = 0;
+  writePage(page, numPages++);
+  if (bloom) {
+    buildBloomFilter(hashes);
+  }
+  if (model) {
+    model->finish(positions);
+    learned = std::move(model);
+    learned_leaf = first_leaf;
+    learned_fill = leaf_fill;
+  }
+
+  BasicIndexPage<K> node(page, codec);
+  size_t fanout = std::max<size_t>(2, (node.capacity - 1) * fill_factor + 1);
+  bool index_children = false;
+  uint8_t height = 1;
+  // Nodes of a level are written next to each other, so the right sibling of a node is the next page
+  auto build = [&](size_t lo, size_t hi) {
+    page.fill(0);
+    node.header->size = hi - lo - 1;
+    node.header->index_children = index_children;
+    node.header->level = height;
+    if (hi < level.size()) {
+      node.setHighKey(level[hi].first);
+      node.header->right = numPages + 1;
+    }
+    for (size_t i = lo; i < hi; i++) {
+      node.children[i - lo] = level[i].second;
+      if (i > lo) {
+        node.setKey(i - lo - 1, level[i].first);
+      }
+    }
+  };
+  while (level.size() > node.capacity) {
+    size_t nodes = (level.size() + fanout - 1) / fanout;
+    std::vector<std::pair<key_type, size_t>> parents;
+    for (size_t i = 0; i < nodes; i++) {
+      size_t lo = level.size() * i / nodes;
+      build(lo, level.size() * (i + 1) / nodes);
+      parents.emplace_back(level[lo].first, numPages);
+      writePage(page, numPages++);
+    }
+    level = std::move(parents);
+    index_children = true;
+    height++;
+  }
+  build(0, level.size());
+  writePage(page, root_id);
+}
+
+template <class K> size_t BasicBTreeFile<K>::getKeyIndex() const { return codec.field(0); }
+
+template <class K> const K &BasicBTreeFile<K>::getKeyCodec() const { return codec; }
+
+template <class K> void BasicBTreeFile<K>::deleteTuple(const Iterator &it) {
+  if (learned) {
+    throw std::logic_error("BTreeFile with a learned index is read-only");
+  }
+  std::unique_lock lock(tree_latch);
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  key_type key;
+  {
+    PageGuard guard(bufferPool, {name, it.page});
+    BasicLeafPage<K> leaf(guard.page, td, codec);
+    if (it.slot >= leaf.header->size) {
+      throw std::out_of_range("slot out of range");
+    }
+    key = leaf.getKey(it.slot);
+  }
+
+  // The index pages from the root to the parent of the leaf
+  std::vector<size_t> path;
+  if (!findPath(root_id, key, it.page, path)) {
+    throw std::logic_error("Iterator does not point to a leaf of the tree");
+  }
+  size_t id = it.page;
+
+  {
+    PageGuard guard(bufferPool, {name, id});
+    bufferPool.markDirty({name, id});
+    BasicLeafPage<K> leaf(guard.page, td, codec);
+    leaf.deleteTuple(it.slot);
+    if (leaf.header->size >= (leaf.capacity - 1) / 2) {
+      return;
+    }
+  }
+
+  bool leaves = true;
+  while (true) {
     size_t parent_id = path.back();
     path.pop_back();
-    pid.page = parent_id;
-    Page &parent_page = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    IndexPage parent(parent_page);
-    if (!parent.insert(new_key, new_child)) {
+    PageGuard parent_guard(bufferPool, {name, parent_id});
+    BasicIndexPage<K> parent(parent_guard.page, codec);
+    bufferPool.markDirty({name, parent_id});
+    if (parent.header->size == 0) {
+      // Only the root can have a single child; if it is an empty leaf, the tree is now empty
+      PageGuard guard(bufferPool, {name, id});
+      if (leaves && BasicLeafPage<K>(guard.page, td, codec).header->size == 0) {
+        parent.header->level = 0;
+        parent.children[0] = 0;
+        freePage(id);
+      }
       return;
     }
 
-    pid.page = numPages++;
-    Page &new_internal_page = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    IndexPage new_internal(new_internal_page);
-    new_key = parent.split(new_internal);
-    new_child = pid.page;
+    // Rebalance the page with its left sibling, or with its right sibling if it is the first child
+    size_t slot = std::find(parent.children, parent.children + parent.header->size + 1, id) - parent.children;
+    size_t sep = slot > 0 ? slot - 1 : 0;
+    size_t left_id = parent.children[sep];
+    size_t right_id = parent.children[sep + 1];
+    key_type separator = parent.getKey(sep);
+    bool merged = leaves ? rebalanceLeaves(left_id, right_id, separator) : rebalanceNodes(left_id, right_id, separator);
+    if (!merged) {
+      parent.setKey(sep, separator);
+      return;
+    }
+    parent.erase(sep);
+    freePage(right_id);
+
+    if (parent_id == root_id) {
+      if (parent.header->size == 0 && parent.header->index_children) {
+        // Replace the root with its only child, keeping the free list
+        size_t child = parent.children[0];
+        {
+          PageGuard guard(bufferPool, {name, child});
+          size_t free_page = parent.header->free_page;
+          parent_guard.page = guard.page;
+          parent.header->free_page = free_page;
+        }
+        freePage(child);
+      }
+      return;
+    }
+    if (parent.header->size >= (parent.capacity - 1) / 2) {
+      return;
+    }
+    id = parent_id;
+    leaves = false;
   }
+}
 
-  bufferPool.markDirty({name, root_id});
-  if (!root.insert(new_key, new_child)) {
-    return;
+template <class K>
+bool BasicBTreeFile<K>::findPath(size_t id, const key_type &key, size_t leaf, std::vector<size_t> &path) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  path.push_back(id);
+  PageGuard guard(bufferPool, {name, id});
+  BasicIndexPage<K> node(guard.page, codec);
+  // Tuples with the same key as a separator can be on both sides of it
+  size_t first = node.lower_bound(key);
+  size_t last = node.upper_bound(key);
+  for (size_t i = first; i <= last; i++) {
+    size_t child = node.children[i];
+    if (node.header->index_children ? findPath(child, key, leaf, path) : child == leaf) {
+      return true;
+    }
   }
-  pid.page = numPages++;
-  Page &new_child1 = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
-  size_t child1 = pid.page;
-  new_child1 = root_page;
-  IndexPage child1_page(new_child1);
+  path.pop_back();
+  return false;
+}
 
-  pid.page = numPages++;
-  Page &new_child2 = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
-  size_t child2 = pid.page;
-  IndexPage child2_page(new_child2);
+template <class K> bool BasicBTreeFile<K>::rebalanceLeaves(size_t left_id, size_t right_id, key_type &separator) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard left_guard(bufferPool, {name, left_id});
+  PageGuard right_guard(bufferPool, {name, right_id});
+  bufferPool.markDirty({name, left_id});
+  bufferPool.markDirty({name, right_id});
+  BasicLeafPage<K> left(left_guard.page, td, codec);
+  BasicLeafPage<K> right(right_guard.page, td, codec);
 
-  int key = child1_page.split(child2_page);
-  root.header->size = 1;
-  root.header->index_children = true;
-  root.keys[0] = key;
-  root.children[0] = child1;
-  root.children[1] = child2;
+  size_t total = left.header->size + right.header->size;
+  if (total < left.capacity) {
+    for (size_t i = 0; i < right.header->size; i++) {
+      left.insertTuple(right.getTuple(i), unique);
+    }
+    left.header->next_leaf = right.header->next_leaf;
+    left.setHighKey(right.getHighKey());
+    if (left.header->next_leaf == 0) {
+      rightmost[0] = left_id;
+    }
+    return true;
+  }
+
+  size_t half = total / 2;
+  while (left.header->size > half) {
+    size_t last = left.header->size - 1;
+    right.insertTuple(left.getTuple(last), unique);
+    left.deleteTuple(last);
+  }
+  while (left.header->size < half) {
+    left.insertTuple(right.getTuple(0), unique);
+    right.deleteTuple(0);
+  }
+  separator = right.getKey(0);
+  left.setHighKey(separator);
+  return false;
 }
 
-void BTreeFile::deleteTuple(const Iterator &it) {
+template <class K> bool BasicBTreeFile<K>::rebalanceNodes(size_t left_id, size_t right_id, key_type &separator) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard left_guard(bufferPool, {name, left_id});
+  PageGuard right_guard(bufferPool, {name, right_id});
+  bufferPool.markDirty({name, left_id});
+  bufferPool.markDirty({name, right_id});
+  BasicIndexPage<K> left(left_guard.page, codec);
+  BasicIndexPage<K> right(right_guard.page, codec);
+
+  // The separator moves down between the keys of the two pages
+  std::vector<key_type> keys;
+  for (size_t i = 0; i < left.header->size; i++) {
+    keys.push_back(left.getKey(i));
+  }
+  keys.push_back(separator);
+  for (size_t i = 0; i < right.header->size; i++) {
+    keys.push_back(right.getKey(i));
+  }
+  std::vector<size_t> children(left.children, left.children + left.header->size + 1);
+  children.insert(children.end(), right.children, right.children + right.header->size + 1);
+
+  if (keys.size() < left.capacity) {
+    for (size_t i = 0; i < keys.size(); i++) {
+      left.setKey(i, keys[i]);
+    }
+    std::copy(children.begin(), children.end(), left.children);
+    left.header->size = keys.size();
+    left.header->right = right.header->right;
+    left.setHighKey(right.getHighKey());
+    if (left.header->right == 0 && left.header->level < rightmost.size()) {
+      rightmost[left.header->level] = left_id;
+    }
+    return true;
+  }
+
+  size_t half = keys.size() / 2;
+  for (size_t i = 0; i < half; i++) {
+    left.setKey(i, keys[i]);
+  }
+  std::copy(children.begin(), children.begin() + half + 1, left.children);
+  left.header->size = half;
+  for (size_t i = half + 1; i < keys.size(); i++) {
+    right.setKey(i - half - 1, keys[i]);
+  }
+  std::copy(children.begin() + half + 1, children.end(), right.children);
+  right.header->size = keys.size() - half - 1;
+  separator = keys[half];
+  left.setHighKey(separator);
+  return false;
 }
 
-Tuple BTreeFile::getTuple(const Iterator &it) const {
+template <class K> Tuple BasicBTreeFile<K>::getTuple(const Iterator &it) const {
   BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, it.page};
-  Page &page = bufferPool.getPage(pid);
-  LeafPage leaf(page, td, key_index);
+  LatchGuard guard(bufferPool, {name, it.page}, false);
+  BasicLeafPage<K> leaf(guard.page, td, codec);
   return leaf.getTuple(it.slot);
 }
 
-void BTreeFile::next(Iterator &it) const {
+template <class K> void BasicBTreeFile<K>::next(Iterator &it) const {
   BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, it.page};
-  Page &page = bufferPool.getPage(pid);
-  LeafPage leaf(page, td, key_index);
+  LatchGuard guard(bufferPool, {name, it.page}, false);
+  BasicLeafPage<K> leaf(guard.page, td, codec);
   if (it.slot + 1 < leaf.header->size) {
     it.slot++;
   } else {
@@ -118,12 +898,12 @@ void BTreeFile::next(Iterator &it) const {
   }
 }
 
-Iterator BTreeFile::begin() const {
+template <class K> Iterator BasicBTreeFile<K>::begin() const {
   BufferPool &bufferPool = getDatabase().getBufferPool();
   PageId pid{name, root_id};
   while (true) {
-    Page &page = bufferPool.getPage(pid);
-    IndexPage node(page);
+    LatchGuard guard(bufferPool, pid, false);
+    BasicIndexPage<K> node(guard.page, codec);
     pid.page = node.children[0];
     if (!node.header->index_children) {
       break;
@@ -132,6 +912,164 @@ Iterator BTreeFile::begin() const {
   return {*this, pid.page, 0};
 }
 
-Iterator BTreeFile::end() const {
+template <class K> Iterator BasicBTreeFile<K>::end() const {
   return {*this, 0, 0};
 }
+
+template <class K> size_t BasicBTreeFile<K>::descend(const key_type &key, uint8_t level, bool lower) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  size_t id = root_id;
+  while (true) {
+    LatchGuard guard(bufferPool, {name, id}, false);
+    BasicIndexPage<K> node(guard.page, codec);
+    if (node.pastHighKey(key, lower)) {
+      id = node.header->right;
+      continue;
+    }
+    if (node.header->level <= level) {
+      return id;
+    }
+    size_t child = lower ? node.children[node.lower_bound(key)] : node.findChild(key);
+    if (node.header->level == level + 1) {
+      return child;
+    }
+    id = child;
+  }
+}
+
+template <class K> size_t BasicBTreeFile<K>::findLeaf(const key_type &key) const { return descend(key, 0, false); }
+
+template <class K>
+void BasicBTreeFile<K>::latchLeaf(std::optional<LatchGuard> &guard, size_t &id, const key_type &key, bool exclusive,
+                                  bool lower) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  while (true) {
+    guard.emplace(bufferPool, PageId{name, id}, exclusive);
+    BasicLeafPage<K> leaf(guard->page, td, codec);
+    if (!leaf.pastHighKey(key, lower)) {
+      return;
+    }
+    id = leaf.header->next_leaf;
+  }
+}
+
+template <class K>
+size_t BasicBTreeFile<K>::seek(std::optional<LatchGuard> &guard, size_t &id, const key_type &key) const {
+  if (learned) {
+    return seekLearned(guard, id, key);
+  }
+  id = descend(key, 0, !unique);
+  if (id == root_id) {
+    return 0;
+  }
+  latchLeaf(guard, id, key, false, !unique);
+  BasicLeafPage<K> leaf(guard->page, td, codec);
+  size_t slot = leaf.lower_bound(key);
+  if (slot == leaf.header->size && !unique && leaf.header->next_leaf != 0) {
+    // With duplicate keys, the leftmost leaf that may hold the key can end just before it
+    id = leaf.header->next_leaf;
+    guard.emplace(getDatabase().getBufferPool(), PageId{name, id}, false);
+    slot = BasicLeafPage<K>(guard->page, td, codec).lower_bound(key);
+  }
+  return slot;
+}
+
+template <class K> Iterator BasicBTreeFile<K>::position(size_t leaf, size_t slot, size_t size, size_t next_leaf) const {
+  if (slot < size) {
+    return {*this, leaf, slot};
+  }
+  return {*this, next_leaf, 0};
+}
+
+template <class K> Iterator BasicBTreeFile<K>::find(const key_type &key) const {
+  std::shared_lock lock(tree_latch);
+  if (!mayContain(key)) {
+    return end();
+  }
+  std::optional<LatchGuard> guard;
+  size_t id;
+  size_t slot = seek(guard, id, key);
+  if (!guard) {
+    missed();
+    return end();
+  }
+  BasicLeafPage<K> leaf(guard->page, td, codec);
+  if (slot == leaf.header->size || leaf.getKey(slot) != key) {
+    missed();
+    return end();
+  }
+  return {*this, id, slot};
+}
+
+template <class K> Iterator BasicBTreeFile<K>::lower_bound(const key_type &key) const {
+  std::shared_lock lock(tree_latch);
+  std::optional<LatchGuard> guard;
+  size_t id;
+  size_t slot = seek(guard, id, key);
+  if (!guard) {
+    return end();
+  }
+  BasicLeafPage<K> leaf(guard->page, td, codec);
+  return position(id, slot, leaf.header->size, leaf.header->next_leaf);
+}
+
+template <class K> Iterator BasicBTreeFile<K>::upper_bound(const key_type &key) const {
+  std::shared_lock lock(tree_latch);
+  size_t id = findLeaf(key);
+  if (id == root_id) {
+    return end();
+  }
+  std::optional<LatchGuard> guard;
+  latchLeaf(guard, id, key, false);
+  BasicLeafPage<K> leaf(guard->page, td, codec);
+  return position(id, leaf.upper_bound(key), leaf.header->size, leaf.header->next_leaf);
+}
+
+template <class K> Morsel BasicBTreeFile<K>::range(const key_type &lo, const key_type &hi) const {
+  if (lo >= hi) {
+    return {end(), end()};
+  }
+  return {lower_bound(lo), lower_bound(hi)};
+}
+
+template <class K> std::vector<Morsel> BasicBTreeFile<K>::partition(size_t n) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  std::vector<size_t> level{root_id};
+  bool index_level = true;
+  while (level.size() < n && index_level) {
+    std::vector<size_t> children;
+    for (size_t id : level) {
+      PageGuard guard(bufferPool, {name, id});
+      BasicIndexPage<K> node(guard.page, codec);
+      children.insert(children.end(), node.children, node.children + node.header->size + 1);
+      index_level = node.header->index_children;
+    }
+    level = std::move(children);
+  }
+  n = std::min(n, level.size());
+  if (n <= 1) {
+    return {{begin(), end()}};
+  }
+
+  std::vector<Morsel> morsels;
+  std::vector<size_t> heads;
+  for (size_t i = 0; i < n; i++) {
+    PageId pid{name, level[level.size() * i / n]};
+    bool index_node = index_level;
+    while (index_node) {
+      PageGuard guard(bufferPool, pid);
+      BasicIndexPage<K> node(guard.page, codec);
+      pid.page = node.children[0];
+      index_node = node.header->index_children;
+    }
+    heads.push_back(pid.page);
+  }
+  for (size_t i = 0; i < n; i++) {
+    Iterator last = i + 1 < n ? Iterator{*this, heads[i + 1], 0} : end();
+    morsels.push_back({{*this, heads[i], 0}, last});
+  }
+  return morsels;
+}
+
+template class db::BasicBTreeFile<IntKey>;
+template class db::BasicBTreeFile<NormalizedKey>;
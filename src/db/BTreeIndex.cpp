@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <climits>
+#include <db/BTreeIndex.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+TupleDesc entryDesc(const TupleDesc &td, const std::vector<size_t> &include) {
+  std::vector<type_t> types{type_t::INT, type_t::INT, type_t::INT};
+  std::vector<std::string> names{"key", "page", "slot"};
+  for (size_t field : include) {
+    types.push_back(td.type_of(field));
+    names.push_back(td.name_of(field));
+  }
+  return {types, names};
+}
+
+// Entries are ordered by key and then by record id, so every entry has a distinct key
+NormalizedKey entryKey() {
+  return {TupleDesc({type_t::INT, type_t::INT, type_t::INT}, {"key", "page", "slot"}), {0, 1, 2}};
+}
+} // namespace
+
+BTreeIndex::BTreeIndex(const std::string &name, size_t field) : BTreeIndex(name, {}, field, {}) {}
+
+BTreeIndex::BTreeIndex(const std::string &name, const TupleDesc &td, size_t field, const std::vector<size_t> &include)
+    : BasicBTreeFile(name, entryDesc(td, include), entryKey()), field(field), include(include) {}
+
+size_t BTreeIndex::getField() const { return field; }
+
+bool BTreeIndex::covers(const std::vector<size_t> &fields) const {
+  return std::all_of(fields.begin(), fields.end(), [&](size_t f) {
+    return f == field || std::find(include.begin(), include.end(), f) != include.end();
+  });
+}
+
+size_t BTreeIndex::entryField(size_t field) const {
+  if (field == this->field) {
+    return 0;
+  }
+  auto it = std::find(include.begin(), include.end(), field);
+  if (it == include.end()) {
+    throw std::logic_error("Field is not covered by the index");
+  }
+  return 3 + (it - include.begin());
+}
+
+void BTreeIndex::insertEntry(const Tuple &t, size_t page, size_t slot) {
+  std::vector<field_t> entry{t.get_field(field), static_cast<int>(page), static_cast<int>(slot)};
+  for (size_t f : include) {
+    entry.push_back(t.get_field(f));
+  }
+  insertTuple(entry);
+}
+
+void BTreeIndex::deleteEntry(int key, size_t page, size_t slot) {
+  Iterator it = find(getKeyCodec().encode({key, static_cast<int>(page), static_cast<int>(slot)}));
+  if (it == end()) {
+    throw std::logic_error("Index entry does not exist");
+  }
+  deleteTuple(it);
+}
+
+Morsel BTreeIndex::entries(int lo, int hi) const {
+  if (lo > hi) {
+    return {end(), end()};
+  }
+  // Record ids are not negative, so (key, 0, 0) is not greater than any entry of the key
+  Iterator first = lower_bound(getKeyCodec().encode({lo, 0, 0}));
+  Iterator last = hi == INT_MAX ? end() : lower_bound(getKeyCodec().encode({hi + 1, 0, 0}));
+  return {first, last};
+}
+
+std::vector<Iterator> BTreeIndex::rids(const DbFile &heap, int lo, int hi) const {
+  std::vector<std::pair<size_t, size_t>> rids;
+  for (const Tuple &t : entries(lo, hi)) {
+    rids.emplace_back(std::get<int>(t.get_field(1)), std::get<int>(t.get_field(2)));
+  }
+  std::sort(rids.begin(), rids.end());
+  std::vector<Iterator> result;
+  result.reserve(rids.size());
+  for (const auto &[page, slot] : rids) {
+    result.emplace_back(heap, page, slot);
+  }
+  return result;
+}
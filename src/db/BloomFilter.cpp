@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <db/BloomFilter.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DB_BLOOM_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace db;
+
+namespace {
+/// The odd constants that choose the bit of each word of a block
+constexpr uint32_t SALTS[8] = {0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+                               0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31};
+
+uint64_t mix(uint64_t h) {
+  // The finalizer of MurmurHash3
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53;
+  h ^= h >> 33;
+  return h;
+}
+
+uint64_t bit(uint32_t hash, size_t word) { return uint64_t{1} << ((hash * SALTS[word]) >> 26); }
+
+#ifdef DB_BLOOM_AVX2
+const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+__attribute__((target("avx2"))) bool containsAvx2(const uint64_t *words, uint32_t hash) {
+  const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(SALTS));
+  __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts), 26);
+  const __m256i one = _mm256_set1_epi64x(1);
+  __m256i lo = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bits)));
+  __m256i hi = _mm256_sllv_epi64(one, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bits, 1)));
+  // testc is set if every bit of the mask is set in the block
+  return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(words)), lo) &
+         _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(words + 4)), hi);
+}
+#endif
+} // namespace
+
+BloomFilter::BloomFilter(size_t keys, size_t bits_per_key)
+    : blocks(sizeFor(keys, bits_per_key) / sizeof(Block), Block{}) {}
+
+BloomFilter::BloomFilter(const uint8_t *data, size_t size) : blocks(std::max<size_t>(1, size / sizeof(Block)), Block{}) {
+  std::memcpy(blocks.data(), data, std::min(size, blocks.size() * sizeof(Block)));
+}
+
+size_t BloomFilter::sizeFor(size_t keys, size_t bits_per_key) {
+  size_t bits = sizeof(Block) * 8;
+  return std::max<size_t>(1, (keys * bits_per_key + bits - 1) / bits) * sizeof(Block);
+}
+
+uint64_t BloomFilter::hash(int key) { return mix(static_cast<uint32_t>(key)); }
+
+uint64_t BloomFilter::hash(const std::string &key) {
+  // FNV-1a
+  uint64_t h = 0xcbf29ce484222325;
+  for (char c : key) {
+    h = (h ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+  }
+  return mix(h);
+}
+
+void BloomFilter::insert(uint64_t hash) {
+  Block &block = blocks[((hash >> 32) * blocks.size()) >> 32];
+  for (size_t i = 0; i < 8; i++) {
+    std::atomic_ref<uint64_t>(block.words[i]).fetch_or(bit(hash, i), std::memory_order_relaxed);
+  }
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const {
+  const Block &block = blocks[((hash >> 32) * blocks.size()) >> 32];
+  bool found = true;
+#ifdef DB_BLOOM_AVX2
+  if (has_avx2) {
+    found = containsAvx2(block.words, static_cast<uint32_t>(hash));
+  } else
+#endif
+  {
+    for (size_t i = 0; i < 8 && found; i++) {
+      found = (block.words[i] & bit(hash, i)) != 0;
+    }
+  }
+  return found;
+}
+
+const uint8_t *BloomFilter::data() const { return reinterpret_cast<const uint8_t *>(blocks.data()); }
+
+size_t BloomFilter::size() const { return blocks.size() * sizeof(Block); }
+
+bool BloomCounters::count(bool may_contain) {
+  probes.fetch_add(1, std::memory_order_relaxed);
+  if (!may_contain) {
+    negatives.fetch_add(1, std::memory_order_relaxed);
+  }
+  return may_contain;
+}
+
+void BloomCounters::addFalsePositive() { false_positives.fetch_add(1, std::memory_order_relaxed); }
+
+BloomStats BloomCounters::get() const { return {probes, negatives, false_positives}; }
@@ -1,6 +1,8 @@
 #include <db/BufferPool.hpp>
 #include <db/Database.hpp>
+#include <algorithm>
 #include <numeric>
+#include <stdexcept>
 
 using namespace db;
 
@@ -15,6 +17,7 @@ BufferPool::~BufferPool() {
 }
 
 Page &BufferPool::getPage(const PageId &pid) {
+  std::lock_guard lock(mutex);
   // If already in buffer pool, make it the most recent page and return it
   if (contains(pid)) {
     size_t pos = pid_to_pos.at(pid);
@@ -23,9 +26,13 @@ Page &BufferPool::getPage(const PageId &pid) {
     return pages[pos];
   }
 
-  // If there are no available pages, evict the least recently used page. If the page is dirty, flush it to disk
+  // If there are no available pages, evict the least recently used unpinned page. If the page is dirty, flush it
   if (available.empty()) {
-    size_t pos = lru_list.back();
+    auto victim = std::find_if(lru_list.rbegin(), lru_list.rend(), [&](size_t pos) { return pins[pos] == 0; });
+    if (victim == lru_list.rend()) {
+      throw std::runtime_error("All pages are pinned");
+    }
+    size_t pos = *victim;
     const PageId &old_pid = pos_to_pid.at(pos);
     if (isDirty(old_pid)) {
       flushPage(old_pid);
@@ -48,19 +55,45 @@ Page &BufferPool::getPage(const PageId &pid) {
   return page;
 }
 
+Page &BufferPool::pinPage(const PageId &pid) {
+  std::lock_guard lock(mutex);
+  Page &page = getPage(pid);
+  pins[pid_to_pos.at(pid)]++;
+  return page;
+}
+
+void BufferPool::unpinPage(const PageId &pid) {
+  std::lock_guard lock(mutex);
+  size_t pos = pid_to_pos.at(pid);
+  if (pins[pos] > 0) {
+    pins[pos]--;
+  }
+}
+
+std::shared_mutex &BufferPool::getLatch(const PageId &pid) {
+  std::lock_guard lock(mutex);
+  return latches[pid_to_pos.at(pid)];
+}
+
 void BufferPool::markDirty(const PageId &pid) {
+  std::lock_guard lock(mutex);
   size_t pos = pid_to_pos.at(pid);
   dirty.insert(pos);
 }
 
 bool BufferPool::isDirty(const PageId &pid) const {
+  std::lock_guard lock(mutex);
   size_t pos = pid_to_pos.at(pid);
   return dirty.contains(pos);
 }
 
-bool BufferPool::contains(const PageId &pid) const { return pid_to_pos.contains(pid); }
+bool BufferPool::contains(const PageId &pid) const {
+  std::lock_guard lock(mutex);
+  return pid_to_pos.contains(pid);
+}
 
 void BufferPool::discardPage(const PageId &pid) {
+  std::lock_guard lock(mutex);
   size_t pos = pid_to_pos.at(pid);
   pid_to_pos.erase(pid);
   pos_to_pid[pos] = {};
@@ -68,10 +101,12 @@ void BufferPool::discardPage(const PageId &pid) {
   lru_list.erase(pos_to_lru[pos]);
   pos_to_lru.erase(pos);
   dirty.erase(pos);
+  pins[pos] = 0;
   available.push_back(pos);
 }
 
 void BufferPool::flushPage(const PageId &pid) {
+  std::lock_guard lock(mutex);
   size_t pos = pid_to_pos.at(pid);
   if (dirty.erase(pos) == 0)
     return;
@@ -80,6 +115,7 @@ void BufferPool::flushPage(const PageId &pid) {
 }
 
 void BufferPool::flushFile(const std::string &file) {
+  std::lock_guard lock(mutex);
   std::vector<size_t> to_flush;
   for (const size_t &pos : dirty) {
     const PageId &pid = pos_to_pid[pos];
@@ -91,3 +127,16 @@ void BufferPool::flushFile(const std::string &file) {
     flushPage({file, page});
   }
 }
+
+void BufferPool::discardFile(const std::string &file) {
+  std::lock_guard lock(mutex);
+  std::vector<size_t> to_discard;
+  for (const auto &[pid, pos] : pid_to_pos) {
+    if (pid.file == file) {
+      to_discard.emplace_back(pid.page);
+    }
+  }
+  for (const auto &page : to_discard) {
+    discardPage({file, page});
+  }
+}
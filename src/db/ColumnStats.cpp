@@ -1,17 +1,47 @@
 #include <db/ColumnStats.hpp>
+#include <numeric>
 
 using namespace db;
 
 ColumnStats::ColumnStats(unsigned buckets, int min, int max)
-// TODO pa4: some code goes here
-{
-  // TODO pa4: some code goes here
+    : min(min), max(max), width(static_cast<int>((static_cast<long long>(max) - min + buckets) / buckets)) {
+  histogram.resize((static_cast<long long>(max) - min) / width + 1);
 }
 
 void ColumnStats::addValue(int v) {
-  // TODO pa4: some code goes here
+  histogram[(static_cast<long long>(v) - min) / width]++;
+  count++;
 }
 
 size_t ColumnStats::estimateCardinality(PredicateOp op, int v) const {
-  // TODO pa4: some code goes here
+  bool keeps_below = op == PredicateOp::LT || op == PredicateOp::LE || op == PredicateOp::NE;
+  bool keeps_above = op == PredicateOp::GT || op == PredicateOp::GE || op == PredicateOp::NE;
+  if (v < min) {
+    return keeps_above ? count : 0;
+  }
+  if (v > max) {
+    return keeps_below ? count : 0;
+  }
+  size_t i = (static_cast<long long>(v) - min) / width;
+  size_t h = histogram[i];
+  // The values of the bucket of v before v, and after v, assuming they are spread uniformly
+  size_t left = static_cast<size_t>(static_cast<long long>(v) - min) - i * width;
+  size_t right = width - 1 - left;
+  size_t below = std::accumulate(histogram.begin(), histogram.begin() + i, size_t{0});
+  size_t above = count - below - h;
+  switch (op) {
+  case PredicateOp::EQ:
+    return h / width;
+  case PredicateOp::NE:
+    return count - h / width;
+  case PredicateOp::LT:
+    return h * left / width + below;
+  case PredicateOp::LE:
+    return h * (left + 1) / width + below;
+  case PredicateOp::GT:
+    return h * right / width + above;
+  case PredicateOp::GE:
+    return h * (right + 1) / width + above;
+  }
+  return 0;
 }
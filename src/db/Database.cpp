@@ -18,12 +18,12 @@ void Database::add(std::unique_ptr<DbFile> file) {
 }
 
 std::unique_ptr<DbFile> Database::remove(const std::string &name) {
-  auto nh = files.extract(name);
-  if (nh.empty()) {
+  if (!files.contains(name)) {
     throw std::logic_error("File does not exist");
   }
-  Database::getBufferPool().flushFile(nh.key());
-  return std::move(nh.mapped());
+  // The dirty pages are written through the file, so it is flushed while it can still be found
+  Database::getBufferPool().flushFile(name);
+  return std::move(files.extract(name).mapped());
 }
 
 DbFile &Database::get(const std::string &name) const { return *files.at(name); }
@@ -56,4 +56,6 @@ Iterator DbFile::begin() const { throw std::runtime_error("Not implemented"); }
 
 Iterator DbFile::end() const { throw std::runtime_error("Not implemented"); }
 
+std::vector<Morsel> DbFile::partition(size_t n) const { return {{begin(), end()}}; }
+
 size_t DbFile::getNumPages() const { return numPages; }
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <bit>
+#include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <db/HashPage.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+/**
+ * @brief Hash a key so that every bit of the key affects the low bits that index the directory.
+ */
+uint32_t hashField(const field_t &value) {
+  uint64_t h;
+  if (std::holds_alternative<int>(value)) {
+    h = static_cast<uint32_t>(std::get<int>(value));
+  } else if (std::holds_alternative<double>(value)) {
+    double d = std::get<double>(value);
+    h = d == 0 ? 0 : std::bit_cast<uint64_t>(d);
+  } else {
+    // FNV-1a over the characters that a CHAR field keeps
+    const std::string &s = std::get<std::string>(value);
+    h = 0xcbf29ce484222325;
+    for (size_t i = 0; i < std::min(s.size(), CHAR_SIZE) && s[i] != 0; i++) {
+      h = (h ^ static_cast<uint8_t>(s[i])) * 0x100000001b3;
+    }
+  }
+  // The finalizer of MurmurHash3
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53;
+  h ^= h >> 33;
+  return static_cast<uint32_t>(h);
+}
+
+size_t getEntry(const std::string &name, const HashFileHeader *header, size_t i) {
+  PageGuard guard(getDatabase().getBufferPool(), {name, header->directory[i / DIRECTORY_PAGE_ENTRIES]});
+  return reinterpret_cast<const size_t *>(guard.page.data())[i % DIRECTORY_PAGE_ENTRIES];
+}
+
+void setEntry(const std::string &name, const HashFileHeader *header, size_t i, size_t id) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageId pid{name, header->directory[i / DIRECTORY_PAGE_ENTRIES]};
+  PageGuard guard(bufferPool, pid);
+  bufferPool.markDirty(pid);
+  reinterpret_cast<size_t *>(guard.page.data())[i % DIRECTORY_PAGE_ENTRIES] = id;
+}
+} // namespace
+
+HashFile::HashFile(const std::string &name, const TupleDesc &td, size_t key_index, bool unique)
+    : DbFile(name, td), key_index(key_index), unique(unique) {}
+
+void HashFile::init() {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, 0});
+  auto *header = reinterpret_cast<HashFileHeader *>(root_guard.page.data());
+  if (header->num_directory_pages != 0) {
+    return;
+  }
+  size_t directory = allocatePage();
+  size_t first = allocatePage();
+  bufferPool.markDirty({name, 0});
+  header->directory[0] = directory;
+  header->num_directory_pages = 1;
+  header->global_depth = 0;
+  setEntry(name, header, 0, first);
+}
+
+size_t HashFile::allocatePage() {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, 0});
+  auto *header = reinterpret_cast<HashFileHeader *>(root_guard.page.data());
+  size_t id = header->free_page;
+  if (id == 0) {
+    return numPages++;
+  }
+  PageGuard guard(bufferPool, {name, id});
+  bufferPool.markDirty({name, 0});
+  bufferPool.markDirty({name, id});
+  header->free_page = *reinterpret_cast<size_t *>(guard.page.data());
+  guard.page.fill(0);
+  return id;
+}
+
+void HashFile::freePage(size_t id) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, 0});
+  PageGuard guard(bufferPool, {name, id});
+  bufferPool.markDirty({name, 0});
+  bufferPool.markDirty({name, id});
+  auto *header = reinterpret_cast<HashFileHeader *>(root_guard.page.data());
+  guard.page.fill(0);
+  *reinterpret_cast<size_t *>(guard.page.data()) = header->free_page;
+  header->free_page = id;
+}
+
+size_t HashFile::bucket(uint32_t hash) const {
+  PageGuard root_guard(getDatabase().getBufferPool(), {name, 0});
+  const auto *header = reinterpret_cast<const HashFileHeader *>(root_guard.page.data());
+  if (header->num_directory_pages == 0) {
+    return 0;
+  }
+  return getEntry(name, header, hash & ((size_t{1} << header->global_depth) - 1));
+}
+
+void HashFile::grow() {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, 0});
+  auto *header = reinterpret_cast<HashFileHeader *>(root_guard.page.data());
+  bufferPool.markDirty({name, 0});
+  size_t n = size_t{1} << header->global_depth;
+  while (header->num_directory_pages * DIRECTORY_PAGE_ENTRIES < 2 * n) {
+    size_t id = allocatePage();
+    header->directory[header->num_directory_pages++] = id;
+  }
+  // The upper half of the directory points to the same buckets as the lower half
+  for (size_t i = 0; i < n; i++) {
+    setEntry(name, header, n + i, getEntry(name, header, i));
+  }
+  header->global_depth++;
+}
+
+void HashFile::split(size_t id) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  PageGuard root_guard(bufferPool, {name, 0});
+  const auto *header = reinterpret_cast<const HashFileHeader *>(root_guard.page.data());
+  uint8_t depth;
+  {
+    PageGuard guard(bufferPool, {name, id});
+    depth = HashPage(guard.page, td).header->depth;
+  }
+  if (depth == header->global_depth) {
+    grow();
+  }
+
+  // Empty the pages of the bucket; the overflow pages are reused by the two new buckets
+  size_t length = td.length();
+  std::vector<uint8_t> tuples;
+  std::vector<uint32_t> hashes;
+  std::vector<size_t> spare;
+  for (size_t page_id = id; page_id != 0;) {
+    PageGuard guard(bufferPool, {name, page_id});
+    HashPage page(guard.page, td);
+    bufferPool.markDirty({name, page_id});
+    tuples.insert(tuples.end(), page.data, page.data + page.header->size * length);
+    hashes.insert(hashes.end(), page.hashes, page.hashes + page.header->size);
+    if (page_id != id) {
+      spare.push_back(page_id);
+    }
+    page_id = page.header->overflow;
+    page.header->size = 0;
+    page.header->overflow = 0;
+  }
+
+  size_t new_id = allocatePage();
+  size_t tails[2] = {id, new_id};
+  for (size_t page_id : tails) {
+    PageGuard guard(bufferPool, {name, page_id});
+    bufferPool.markDirty({name, page_id});
+    HashPage(guard.page, td).header->depth = depth + 1;
+  }
+  for (size_t i = 0; i < hashes.size(); i++) {
+    size_t &tail = tails[(hashes[i] >> depth) & 1];
+    PageGuard guard(bufferPool, {name, tail});
+    HashPage page(guard.page, td);
+    if (page.full()) {
+      size_t next;
+      if (spare.empty()) {
+        next = allocatePage();
+      } else {
+        next = spare.back();
+        spare.pop_back();
+      }
+      page.header->overflow = next;
+      tail = next;
+      PageGuard next_guard(bufferPool, {name, next});
+      bufferPool.markDirty({name, next});
+      HashPage(next_guard.page, td).insertTuple(tuples.data() + i * length, hashes[i]);
+    } else {
+      page.insertTuple(tuples.data() + i * length, hashes[i]);
+    }
+  }
+  for (size_t page_id : spare) {
+    freePage(page_id);
+  }
+
+  // The directory entries of the bucket whose next bit is set now point to the new bucket
+  size_t low = hashes.front() & ((size_t{1} << depth) - 1);
+  for (size_t i = low | (size_t{1} << depth); i < size_t{1} << header->global_depth; i += size_t{2} << depth) {
+    setEntry(name, header, i, new_id);
+  }
+}
+
+void HashFile::insertTuple(const Tuple &t) {
+  if (!td.compatible(t)) {
+    throw std::runtime_error("Tuple not compatible with TupleDesc");
+  }
+  init();
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  const field_t &key = t.get_field(key_index);
+  uint32_t hash = hashField(key);
+  while (true) {
+    size_t first = bucket(hash);
+    size_t room = 0;
+    size_t last = first;
+    uint8_t depth = 0;
+    bool separable = false;
+    for (size_t id = first; id != 0;) {
+      PageGuard guard(bufferPool, {name, id});
+      HashPage page(guard.page, td);
+      if (id == first) {
+        depth = page.header->depth;
+      }
+      for (size_t slot = 0; slot < page.header->size; slot++) {
+        if (page.hashes[slot] != hash) {
+          separable = true;
+        } else if (unique && page.getTuple(slot).get_field(key_index) == key) {
+          bufferPool.markDirty({name, id});
+          page.setTuple(slot, t);
+          return;
+        }
+      }
+      if (room == 0 && !page.full()) {
+        room = id;
+      }
+      last = id;
+      id = page.header->overflow;
+    }
+    if (room != 0) {
+      PageGuard guard(bufferPool, {name, room});
+      bufferPool.markDirty({name, room});
+      HashPage(guard.page, td).insertTuple(t, hash);
+      return;
+    }
+    if (separable && (depth < getGlobalDepth() || getGlobalDepth() < MAX_GLOBAL_DEPTH)) {
+      split(first);
+      continue;
+    }
+    // Splitting would not separate the keys of the bucket
+    size_t id = allocatePage();
+    {
+      PageGuard guard(bufferPool, {name, last});
+      bufferPool.markDirty({name, last});
+      HashPage(guard.page, td).header->overflow = id;
+    }
+    PageGuard guard(bufferPool, {name, id});
+    bufferPool.markDirty({name, id});
+    HashPage(guard.page, td).insertTuple(t, hash);
+    return;
+  }
+}
+
+void HashFile::deleteTuple(const Iterator &it) {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  uint32_t hash;
+  bool empty;
+  {
+    PageGuard guard(bufferPool, {name, it.page});
+    HashPage page(guard.page, td);
+    hash = hashField(page.getTuple(it.slot).get_field(key_index));
+    bufferPool.markDirty({name, it.page});
+    page.deleteTuple(it.slot);
+    empty = page.header->size == 0;
+  }
+  size_t first = bucket(hash);
+  if (!empty || it.page == first) {
+    return;
+  }
+  // Unlink the empty overflow page from its bucket
+  for (size_t id = first; id != 0;) {
+    PageGuard guard(bufferPool, {name, id});
+    HashPage page(guard.page, td);
+    if (page.header->overflow == it.page) {
+      PageGuard victim(bufferPool, {name, it.page});
+      bufferPool.markDirty({name, id});
+      page.header->overflow = HashPage(victim.page, td).header->overflow;
+      break;
+    }
+    id = page.header->overflow;
+  }
+  freePage(it.page);
+}
+
+Tuple HashFile::getTuple(const Iterator &it) const {
+  PageGuard guard(getDatabase().getBufferPool(), {name, it.page});
+  return HashPage(guard.page, td).getTuple(it.slot);
+}
+
+void HashFile::next(Iterator &it) const {
+  if (it.page < numPages) {
+    PageGuard guard(getDatabase().getBufferPool(), {name, it.page});
+    if (++it.slot < HashPage(guard.page, td).header->size) {
+      return;
+    }
+    it.page++;
+  }
+  Iterator found = seek(it.page);
+  it.page = found.page;
+  it.slot = found.slot;
+}
+
+Iterator HashFile::seek(size_t page) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  std::vector<size_t> directory;
+  {
+    PageGuard root_guard(bufferPool, {name, 0});
+    const auto *header = reinterpret_cast<const HashFileHeader *>(root_guard.page.data());
+    directory.assign(header->directory, header->directory + header->num_directory_pages);
+  }
+  for (; page < numPages; page++) {
+    if (page == 0 || std::find(directory.begin(), directory.end(), page) != directory.end()) {
+      continue;
+    }
+    // Free pages are empty
+    PageGuard guard(bufferPool, {name, page});
+    if (HashPage(guard.page, td).header->size != 0) {
+      return {*this, page, 0};
+    }
+  }
+  return end();
+}
+
+Iterator HashFile::begin() const { return seek(1); }
+
+Iterator HashFile::end() const { return {*this, numPages, 0}; }
+
+Iterator HashFile::find(const field_t &key) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  uint32_t hash = hashField(key);
+  for (size_t id = bucket(hash); id != 0;) {
+    PageGuard guard(bufferPool, {name, id});
+    HashPage page(guard.page, td);
+    for (size_t slot = 0; slot < page.header->size; slot++) {
+      if (page.hashes[slot] == hash && page.getTuple(slot).get_field(key_index) == key) {
+        return {*this, id, slot};
+      }
+    }
+    id = page.header->overflow;
+  }
+  return end();
+}
+
+std::vector<Tuple> HashFile::findAll(const field_t &key) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  uint32_t hash = hashField(key);
+  std::vector<Tuple> result;
+  for (size_t id = bucket(hash); id != 0;) {
+    PageGuard guard(bufferPool, {name, id});
+    HashPage page(guard.page, td);
+    for (size_t slot = 0; slot < page.header->size; slot++) {
+      if (page.hashes[slot] == hash) {
+        Tuple t = page.getTuple(slot);
+        if (t.get_field(key_index) == key) {
+          result.push_back(std::move(t));
+        }
+      }
+    }
+    id = page.header->overflow;
+  }
+  return result;
+}
+
+size_t HashFile::getKeyIndex() const { return key_index; }
+
+uint8_t HashFile::getGlobalDepth() const {
+  PageGuard root_guard(getDatabase().getBufferPool(), {name, 0});
+  return reinterpret_cast<const HashFileHeader *>(root_guard.page.data())->global_depth;
+}
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <db/HashPage.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+HashPage::HashPage(Page &page, const TupleDesc &td) : td(td) {
+  header = reinterpret_cast<HashPageHeader *>(page.data());
+  capacity = (DEFAULT_PAGE_SIZE - sizeof(HashPageHeader)) / (td.length() + sizeof(uint32_t));
+  hashes = reinterpret_cast<uint32_t *>(header + 1);
+  data = page.data() + DEFAULT_PAGE_SIZE - td.length() * capacity;
+}
+
+void HashPage::insertTuple(const Tuple &t, uint32_t hash) {
+  if (full()) {
+    throw std::logic_error("HashPage is full");
+  }
+  td.serialize(data + header->size * td.length(), t);
+  hashes[header->size++] = hash;
+}
+
+void HashPage::insertTuple(const uint8_t *tuple, uint32_t hash) {
+  if (full()) {
+    throw std::logic_error("HashPage is full");
+  }
+  std::copy_n(tuple, td.length(), data + header->size * td.length());
+  hashes[header->size++] = hash;
+}
+
+void HashPage::setTuple(size_t slot, const Tuple &t) { td.serialize(data + slot * td.length(), t); }
+
+void HashPage::deleteTuple(size_t slot) {
+  if (slot >= header->size) {
+    throw std::out_of_range("slot out of range");
+  }
+  size_t length = td.length();
+  size_t last = header->size - 1;
+  if (slot != last) {
+    std::copy_n(data + last * length, length, data + slot * length);
+    hashes[slot] = hashes[last];
+  }
+  header->size--;
+}
+
+Tuple HashPage::getTuple(size_t slot) const {
+  if (slot >= header->size) {
+    throw std::out_of_range("slot out of range");
+  }
+  return td.deserialize(data + slot * td.length());
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <db/BTreeIndex.hpp>
 #include <db/Database.hpp>
 #include <db/HeapFile.hpp>
 #include <db/HeapPage.hpp>
@@ -16,65 +18,64 @@ void HeapFile::insertTuple(const Tuple &t) {
   pid.page = numPages - 1;
   Page &p = bufferPool.getPage(pid);
   HeapPage hp(p, td);
-  if (!hp.insertTuple(t)) {
+  size_t slot;
+  if (!hp.insertTuple(t, &slot)) {
     numPages++;
     pid.page++;
     Page &np = bufferPool.getPage(pid);
     HeapPage nhp(np, td);
-    nhp.insertTuple(t);
+    nhp.insertTuple(t, &slot);
   }
   bufferPool.markDirty(pid);
+  for (BTreeIndex *index : indexes) {
+    index->insertEntry(t, pid.page, slot);
+  }
 }
 
 void HeapFile::deleteTuple(const Iterator &it) {
   BufferPool &bufferPool = getDatabase().getBufferPool();
   PageId pid{name, it.page};
-  Page &p = bufferPool.getPage(pid);
-  HeapPage hp(p, td);
+  // Updating the indexes reads their pages, which must not evict this one
+  PageGuard guard(bufferPool, pid);
+  HeapPage hp(guard.page, td);
   bufferPool.markDirty(pid);
+  if (!indexes.empty()) {
+    Tuple t = hp.getTuple(it.slot);
+    for (BTreeIndex *index : indexes) {
+      index->deleteEntry(std::get<int>(t.get_field(index->getField())), it.page, it.slot);
+    }
+  }
   hp.deleteTuple(it.slot);
 }
 
 Tuple HeapFile::getTuple(const Iterator &it) const {
   BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, it.page};
-  Page &p = bufferPool.getPage(pid);
-  HeapPage hp(p, td);
+  PageGuard guard(bufferPool, {name, it.page});
+  HeapPage hp(guard.page, td);
   return hp.getTuple(it.slot);
 }
 
 void HeapFile::next(Iterator &it) const {
   BufferPool &bufferPool = getDatabase().getBufferPool();
   if (it.page < numPages) {
-    PageId pid{name, it.page};
-    Page &p = bufferPool.getPage(pid);
-    const HeapPage hp(p, td);
+    PageGuard guard(bufferPool, {name, it.page});
+    const HeapPage hp(guard.page, td);
     hp.next(it.slot);
     if (it.slot != hp.end()) {
       return;
     }
     it.page++;
   }
-  while (it.page < numPages) {
-    PageId pid{name, it.page};
-    Page &p = bufferPool.getPage(pid);
-    const HeapPage hp(p, td);
-    it.slot = hp.begin();
-    if (it.slot != hp.end()) {
-      return;
-    }
-    it.page++;
-  }
-  it.slot = 0;
+  Iterator found = seek(it.page);
+  it.page = found.page;
+  it.slot = found.slot;
 }
 
-Iterator HeapFile::begin() const {
+Iterator HeapFile::seek(size_t page) const {
   BufferPool &bufferPool = getDatabase().getBufferPool();
-  size_t page = 0;
   while (page < numPages) {
-    PageId pid{name, page};
-    Page &p = bufferPool.getPage(pid);
-    const HeapPage hp(p, td);
+    PageGuard guard(bufferPool, {name, page});
+    const HeapPage hp(guard.page, td);
     size_t slot = hp.begin();
     if (slot != hp.end())
       return {*this, page, slot};
@@ -83,4 +84,52 @@ Iterator HeapFile::begin() const {
   return {*this, numPages, 0};
 }
 
+Iterator HeapFile::begin() const { return seek(0); }
+
 Iterator HeapFile::end() const { return {*this, numPages, 0}; }
+
+std::vector<Morsel> HeapFile::partition(size_t n) const {
+  n = std::clamp<size_t>(n, 1, numPages);
+  std::vector<Iterator> bounds;
+  for (size_t i = 0; i <= n; i++) {
+    bounds.push_back(seek(numPages * i / n));
+  }
+  std::vector<Morsel> morsels;
+  for (size_t i = 0; i < n; i++) {
+    morsels.push_back({bounds[i], bounds[i + 1]});
+  }
+  return morsels;
+}
+
+void HeapFile::addIndex(BTreeIndex &index) {
+  if (td.type_of(index.getField()) != type_t::INT) {
+    throw std::logic_error("Indexed field must be an int");
+  }
+  for (size_t field = 0; field < td.size(); field++) {
+    if (index.covers({field}) && index.getTupleDesc().type_of(index.entryField(field)) != td.type_of(field)) {
+      throw std::logic_error("Included field has a different type");
+    }
+  }
+  for (Iterator it = begin(), last = end(); it != last; ++it) {
+    index.insertEntry(getTuple(it), it.page, it.slot);
+  }
+  indexes.push_back(&index);
+}
+
+const BTreeIndex *HeapFile::getCoveringIndex(const std::vector<size_t> &fields) const {
+  for (const BTreeIndex *index : indexes) {
+    if (index->covers(fields)) {
+      return index;
+    }
+  }
+  return nullptr;
+}
+
+const BTreeIndex *HeapFile::getIndex(size_t field) const {
+  for (const BTreeIndex *index : indexes) {
+    if (index->getField() == field) {
+      return index;
+    }
+  }
+  return nullptr;
+}
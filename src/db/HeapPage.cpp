@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <db/Database.hpp>
 #include <db/HeapPage.hpp>
+#include <db/PageFilter.hpp>
 #include <stdexcept>
 
 using namespace db;
@@ -21,17 +23,20 @@ size_t HeapPage::begin() const {
 
 size_t HeapPage::end() const { return capacity; }
 
-bool HeapPage::insertTuple(const Tuple &t) {
-  size_t slot = 0;
-  while (slot < capacity && (header[slot / 8] & (1 << (7 - slot % 8)))) {
-    slot++;
+bool HeapPage::insertTuple(const Tuple &t, size_t *slot) {
+  size_t free = 0;
+  while (free < capacity && (header[free / 8] & (1 << (7 - free % 8)))) {
+    free++;
   }
-  if (slot == capacity) {
+  if (free == capacity) {
     return false;
   }
-  header[slot / 8] |= 1 << (7 - slot % 8);
-  uint8_t *slotData = data + slot * td.length();
+  header[free / 8] |= 1 << (7 - free % 8);
+  uint8_t *slotData = data + free * td.length();
   td.serialize(slotData, t);
+  if (slot) {
+    *slot = free;
+  }
   return true;
 }
 
@@ -53,6 +58,23 @@ Tuple HeapPage::getTuple(size_t slot) const {
   return td.deserialize(slotData);
 }
 
+const uint8_t *HeapPage::getBytes(size_t slot) const { return data + slot * td.length(); }
+
+void HeapPage::occupied(uint64_t *bits) const {
+  std::fill(bits, bits + pagefilter::words(capacity), 0);
+  for (size_t i = 0; i < (capacity + 7) / 8; i++) {
+    // The header stores slot 0 in the highest bit of a byte
+    uint8_t b = header[i];
+    b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+    b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+    b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+    bits[i / 8] |= static_cast<uint64_t>(b) << (i % 8 * 8);
+  }
+  if (capacity % 64) {
+    bits[capacity / 64] &= (uint64_t{1} << capacity % 64) - 1;
+  }
+}
+
 void HeapPage::next(size_t &slot) const {
   while (++slot < capacity && empty(slot))
     ;
@@ -1,32 +1,85 @@
+#include <algorithm>
 #include <db/IndexPage.hpp>
 #include <stdexcept>
 
 using namespace db;
 
-IndexPage::IndexPage(Page &page) {
-  capacity = (DEFAULT_PAGE_SIZE - sizeof(IndexPageHeader) - sizeof(int)) / (sizeof(int) + sizeof(size_t));
+template <class K> BasicIndexPage<K>::BasicIndexPage(Page &page, const K &codec) : codec(codec) {
+  size_t width = codec.stride() * sizeof(slot_type);
+  // A full page briefly holds capacity keys and capacity + 1 children before it is split
+  capacity = (DEFAULT_PAGE_SIZE - sizeof(IndexPageHeader) - 2 * width - sizeof(size_t)) / (width + sizeof(size_t));
   header = reinterpret_cast<IndexPageHeader *>(page.data());
-  keys = reinterpret_cast<int *>(header + 1);
-  children = reinterpret_cast<size_t *>(keys + capacity + 1);
+  high_key = reinterpret_cast<slot_type *>(header + 1);
+  keys = high_key + codec.stride();
+  children = reinterpret_cast<size_t *>(keys + (capacity + 1) * codec.stride());
 }
 
-bool IndexPage::insert(int key, size_t child) {
-  auto it = std::lower_bound(keys, keys + header->size, key);
-  auto slot = it - keys;
-  std::move_backward(keys + slot, keys + header->size, keys + header->size + 1);
+template <class K> bool BasicIndexPage<K>::insert(const key_type &key, size_t child) {
+  return insertAt(lower_bound(key), key, child);
+}
+
+template <class K> bool BasicIndexPage<K>::insertAt(size_t slot, const key_type &key, size_t child) {
+  size_t stride = codec.stride();
+  std::move_backward(keys + slot * stride, keys + header->size * stride, keys + (header->size + 1) * stride);
   std::move_backward(children + slot + 1, children + header->size + 1, children + header->size + 2);
-  keys[slot] = key;
+  codec.store(keys + slot * stride, key);
   children[slot + 1] = child;
   ++header->size;
   return header->size == capacity;
 }
 
-int IndexPage::split(IndexPage &new_page) {
-  size_t half = header->size / 2;
+template <class K> void BasicIndexPage<K>::erase(size_t slot) {
+  if (slot >= header->size) {
+    throw std::out_of_range("slot out of range");
+  }
+  size_t stride = codec.stride();
+  std::move(keys + (slot + 1) * stride, keys + header->size * stride, keys + slot * stride);
+  std::move(children + slot + 2, children + header->size + 1, children + slot + 1);
+  --header->size;
+}
+
+template <class K> typename K::key_type BasicIndexPage<K>::getKey(size_t slot) const {
+  return codec.load(keys + slot * codec.stride());
+}
+
+template <class K> void BasicIndexPage<K>::setKey(size_t slot, const key_type &key) {
+  codec.store(keys + slot * codec.stride(), key);
+}
+
+template <class K> typename K::key_type BasicIndexPage<K>::getHighKey() const { return codec.load(high_key); }
+
+template <class K> void BasicIndexPage<K>::setHighKey(const key_type &key) { codec.store(high_key, key); }
+
+template <class K> size_t BasicIndexPage<K>::lower_bound(const key_type &key) const {
+  return codec.lower_bound(keys, header->size, key);
+}
+
+template <class K> size_t BasicIndexPage<K>::upper_bound(const key_type &key) const {
+  return codec.upper_bound(keys, header->size, key);
+}
+
+template <class K> size_t BasicIndexPage<K>::findChild(const key_type &key) const {
+  return children[upper_bound(key)];
+}
+
+template <class K> bool BasicIndexPage<K>::pastHighKey(const key_type &key, bool lower) const {
+  return header->right != 0 && codec.compare(key, high_key) >= (lower ? 1 : 0);
+}
+
+template <class K> typename K::key_type BasicIndexPage<K>::split(BasicIndexPage &new_page, double fill) {
+  size_t half = std::clamp<size_t>(header->size * fill, 1, header->size - 1);
+  size_t stride = codec.stride();
   new_page.header->size = header->size - half - 1;
   new_page.header->index_children = header->index_children;
-  std::copy(keys + half + 1, keys + header->size, new_page.keys);
+  new_page.header->level = header->level;
+  new_page.header->right = header->right;
+  std::copy_n(high_key, stride, new_page.high_key);
+  std::copy_n(keys + half * stride, stride, high_key);
+  std::copy(keys + (half + 1) * stride, keys + header->size * stride, new_page.keys);
   std::copy(children + half + 1, children + header->size + 1, new_page.children);
   header->size = half;
-  return keys[half];
+  return getHighKey();
 }
+
+template struct db::BasicIndexPage<IntKey>;
+template struct db::BasicIndexPage<NormalizedKey>;
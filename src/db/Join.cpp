@@ -0,0 +1,611 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <db/Join.hpp>
+#include <numeric>
+#include <stdexcept>
+
+using namespace db;
+using namespace db::op;
+
+namespace {
+uint64_t mix(uint64_t h) {
+  h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdULL;
+  h = (h ^ (h >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+  return h ^ (h >> 33);
+}
+
+/// Run `f(i, worker)` for every i < n, on up to `threads` threads that each claim the next i
+template <typename F> void parallelFor(size_t n, size_t threads, F f) {
+  threads = std::min(threads, n);
+  if (threads <= 1) {
+    for (size_t i = 0; i < n; i++) {
+      f(i, 0);
+    }
+    return;
+  }
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < threads; w++) {
+    workers.emplace_back([&, w] {
+      for (size_t i = next++; i < n; i = next++) {
+        f(i, w);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Scatter entries to 2^bits partitions by the bits of their hash that start at `shift`
+ * @param bounds the position of the first entry of each partition in `out`, and the number of entries
+ */
+void scatter(const RadixJoin::Entry *in, size_t n, RadixJoin::Entry *out, unsigned shift, unsigned bits,
+             size_t *bounds) {
+  constexpr size_t LINE = 64 / sizeof(RadixJoin::Entry);
+  struct alignas(64) Line {
+    RadixJoin::Entry entries[LINE];
+  };
+  size_t fan_out = size_t{1} << bits;
+  uint64_t mask = fan_out - 1;
+  std::vector<size_t> offsets(fan_out + 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    offsets[(in[i].hash >> shift & mask) + 1]++;
+  }
+  for (size_t p = 0; p < fan_out; p++) {
+    offsets[p + 1] += offsets[p];
+  }
+  std::copy(offsets.begin(), offsets.end(), bounds);
+
+  std::vector<Line> lines(fan_out);
+  std::vector<uint8_t> fill(fan_out, 0);
+  for (size_t i = 0; i < n; i++) {
+    size_t p = in[i].hash >> shift & mask;
+    lines[p].entries[fill[p]++] = in[i];
+    if (fill[p] == LINE) {
+      std::memcpy(out + offsets[p], lines[p].entries, sizeof(Line));
+      offsets[p] += LINE;
+      fill[p] = 0;
+    }
+  }
+  for (size_t p = 0; p < fan_out; p++) {
+    std::memcpy(out + offsets[p], lines[p].entries, fill[p] * sizeof(RadixJoin::Entry));
+  }
+}
+} // namespace
+
+HashJoin::HashJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred, size_t memory)
+    : Join(std::move(left), std::move(right), std::move(pred)), memory(memory) {
+  if (this->pred.op != PredicateOp::EQ) {
+    throw std::logic_error("A hash join needs an equality");
+  }
+}
+
+size_t HashJoin::partitionOf(const field_t &key, size_t depth) const {
+  // Mix the hash with the level, so that a partition is split by the next level
+  return mix(std::hash<field_t>{}(key) + (depth + 1) * 0x9e3779b97f4a7c15ULL) % HASH_JOIN_FAN_OUT;
+}
+
+void HashJoin::spill(Spill &spill, const TupleDesc &td, size_t field, size_t depth, const Tuple &t) {
+  if (spill.files.empty()) {
+    for (size_t i = 0; i < HASH_JOIN_FAN_OUT; i++) {
+      spill.files.push_back(std::make_unique<TempFile>("join", td));
+    }
+    spill.counts.assign(HASH_JOIN_FAN_OUT, 0);
+    stats.partitions += HASH_JOIN_FAN_OUT;
+    stats.depth = std::max(stats.depth, depth + 1);
+  }
+  size_t i = partitionOf(t.get_field(field), depth);
+  spill.files[i]->file().insertTuple(t);
+  spill.counts[i]++;
+  stats.spilled_tuples++;
+  stats.spilled_bytes += td.length();
+}
+
+void HashJoin::addPartitions(Spill lefts, Spill rights, size_t depth) {
+  if (lefts.files.empty() || rights.files.empty()) {
+    return;
+  }
+  for (size_t i = 0; i < HASH_JOIN_FAN_OUT; i++) {
+    if (lefts.counts[i] > 0 && rights.counts[i] > 0) {
+      pending.push_back({std::move(lefts.files[i]), std::move(rights.files[i]), rights.counts[i], depth});
+    }
+  }
+}
+
+bool HashJoin::nextPartition() {
+  partition_scan.reset();
+  joined = {};
+  table.clear();
+  const TupleDesc &left_td = left->getTupleDesc();
+  const TupleDesc &right_td = right->getTupleDesc();
+  while (!pending.empty()) {
+    Partition p = std::move(pending.back());
+    pending.pop_back();
+    if (p.right_tuples * right_td.length() > memory && p.depth + 1 < HASH_JOIN_MAX_DEPTH) {
+      Spill lefts;
+      Spill rights;
+      for (const auto &t : p.right->file()) {
+        spill(rights, right_td, right_field, p.depth + 1, t);
+      }
+      for (const auto &t : p.left->file()) {
+        spill(lefts, left_td, left_field, p.depth + 1, t);
+      }
+      addPartitions(std::move(lefts), std::move(rights), p.depth + 1);
+      continue;
+    }
+    for (const auto &t : p.right->file()) {
+      table.emplace(t.get_field(right_field), t);
+    }
+    match = match_end = table.end();
+    joined = std::move(p);
+    partition_scan = std::make_unique<Scan>(joined.left->file());
+    partition_scan->open();
+    probe = partition_scan.get();
+    return true;
+  }
+  probe = nullptr;
+  return false;
+}
+
+void HashJoin::open() {
+  partition_scan.reset();
+  joined = {};
+  pending.clear();
+  table.clear();
+  current.reset();
+  stats = {};
+  const TupleDesc &right_td = right->getTupleDesc();
+  Spill rights;
+  size_t bytes = 0;
+  right->open();
+  while (auto t = right->next()) {
+    if (rights.files.empty() && bytes + right_td.length() <= memory) {
+      bytes += right_td.length();
+      field_t key = t->get_field(right_field);
+      table.emplace(std::move(key), std::move(*t));
+      continue;
+    }
+    if (rights.files.empty()) {
+      // The right child does not fit: move the table to the partitions, then the rest of the child
+      for (const auto &[key, r] : table) {
+        spill(rights, right_td, right_field, 0, r);
+      }
+      table.clear();
+    }
+    spill(rights, right_td, right_field, 0, *t);
+  }
+  right->close();
+
+  left->open();
+  match = match_end = table.end();
+  if (rights.files.empty()) {
+    probe = left.get();
+    return;
+  }
+  Spill lefts;
+  while (auto t = left->next()) {
+    spill(lefts, left->getTupleDesc(), left_field, 0, *t);
+  }
+  left->close();
+  addPartitions(std::move(lefts), std::move(rights), 0);
+  nextPartition();
+}
+
+std::optional<Tuple> HashJoin::next() {
+  while (match == match_end) {
+    if (!probe) {
+      return std::nullopt;
+    }
+    current = probe->next();
+    if (!current) {
+      if (probe == left.get() || !nextPartition()) {
+        probe = nullptr;
+      }
+      continue;
+    }
+    std::tie(match, match_end) = table.equal_range(current->get_field(left_field));
+  }
+  return concat(*current, (match++)->second);
+}
+
+void HashJoin::close() {
+  Join::close();
+  probe = nullptr;
+  partition_scan.reset();
+  joined = {};
+  pending.clear();
+}
+
+const HashJoin::Stats &HashJoin::getStats() const { return stats; }
+
+RadixJoin::RadixJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred,
+                     size_t threads, size_t partition_tuples)
+    : Join(std::move(left), std::move(right), std::move(pred)), threads(std::max<size_t>(threads, 1)),
+      partition_tuples(std::max<size_t>(partition_tuples, 1)) {
+  if (this->pred.op != PredicateOp::EQ) {
+    throw std::logic_error("A radix join needs an equality");
+  }
+}
+
+std::vector<size_t> RadixJoin::partition(std::vector<Entry> &entries) const {
+  size_t n = entries.size();
+  if (bits == 0) {
+    return {0, n};
+  }
+  std::vector<Entry> out(n);
+  std::vector<size_t> bounds((size_t{1} << bits) + 1);
+  if (bits <= RADIX_JOIN_PASS_BITS) {
+    scatter(entries.data(), n, out.data(), 64 - bits, bits, bounds.data());
+    entries.swap(out);
+    return bounds;
+  }
+  // The first pass splits on the top half of the bits, and the second pass splits each partition on the other half
+  unsigned first = bits / 2;
+  unsigned second = bits - first;
+  std::vector<size_t> coarse((size_t{1} << first) + 1);
+  scatter(entries.data(), n, out.data(), 64 - first, first, coarse.data());
+  parallelFor(coarse.size() - 1, threads, [&](size_t i, size_t) {
+    std::vector<size_t> fine((size_t{1} << second) + 1);
+    scatter(out.data() + coarse[i], coarse[i + 1] - coarse[i], entries.data() + coarse[i], 64 - bits, second,
+            fine.data());
+    for (size_t p = 0; p + 1 < fine.size(); p++) {
+      bounds[(i << second) + p] = coarse[i] + fine[p];
+    }
+  });
+  bounds.back() = n;
+  return bounds;
+}
+
+void RadixJoin::open() {
+  current.reset();
+  left_done = true;
+  lefts.clear();
+  pairs.clear();
+  pair = 0;
+
+  right->open();
+  rights.clear();
+  while (auto t = right->next()) {
+    rights.push_back(std::move(*t));
+  }
+  right->close();
+
+  bits = 0;
+  while (bits < 2 * RADIX_JOIN_PASS_BITS && rights.size() >> bits > partition_tuples) {
+    bits++;
+  }
+  std::vector<Entry> entries(rights.size());
+  for (size_t i = 0; i < rights.size(); i++) {
+    entries[i] = {mix(std::hash<field_t>{}(rights[i].get_field(right_field))), i};
+  }
+  std::vector<size_t> bounds = partition(entries);
+
+  // Each table has a power of two slots, at least twice its entries
+  size_t partitions = bounds.size() - 1;
+  table_offsets.assign(partitions + 1, 0);
+  for (size_t p = 0; p < partitions; p++) {
+    size_t count = bounds[p + 1] - bounds[p];
+    table_offsets[p + 1] = table_offsets[p] + (count ? std::bit_ceil(2 * count) : 0);
+  }
+  slots.assign(table_offsets.back(), {0, EMPTY});
+  parallelFor(partitions, threads, [&](size_t p, size_t) {
+    Entry *table = slots.data() + table_offsets[p];
+    size_t mask = table_offsets[p + 1] - table_offsets[p] - 1;
+    for (size_t i = bounds[p]; i < bounds[p + 1]; i++) {
+      size_t slot = entries[i].hash & mask;
+      while (table[slot].row != EMPTY) {
+        slot = (slot + 1) & mask;
+      }
+      table[slot] = entries[i];
+    }
+  });
+
+  left->open();
+  left_done = rights.empty();
+}
+
+void RadixJoin::probeChunk() {
+  lefts.clear();
+  pairs.clear();
+  pair = 0;
+  while (lefts.size() < RADIX_JOIN_CHUNK) {
+    auto t = left->next();
+    if (!t) {
+      left_done = true;
+      break;
+    }
+    lefts.push_back(std::move(*t));
+  }
+  std::vector<Entry> entries(lefts.size());
+  for (size_t i = 0; i < lefts.size(); i++) {
+    entries[i] = {mix(std::hash<field_t>{}(lefts[i].get_field(left_field))), i};
+  }
+  std::vector<size_t> bounds = partition(entries);
+
+  std::vector<std::vector<std::pair<size_t, size_t>>> found(std::min(threads, bounds.size() - 1));
+  parallelFor(bounds.size() - 1, threads, [&](size_t p, size_t worker) {
+    const Entry *table = slots.data() + table_offsets[p];
+    size_t size = table_offsets[p + 1] - table_offsets[p];
+    if (size == 0) {
+      return;
+    }
+    for (size_t i = bounds[p]; i < bounds[p + 1]; i++) {
+      const Entry &e = entries[i];
+      const field_t &key = lefts[e.row].get_field(left_field);
+      for (size_t slot = e.hash & (size - 1); table[slot].row != EMPTY; slot = (slot + 1) & (size - 1)) {
+        if (table[slot].hash == e.hash && rights[table[slot].row].get_field(right_field) == key) {
+          found[worker].emplace_back(e.row, table[slot].row);
+        }
+      }
+    }
+  });
+  for (auto &f : found) {
+    pairs.insert(pairs.end(), f.begin(), f.end());
+  }
+}
+
+std::optional<Tuple> RadixJoin::next() {
+  while (pair == pairs.size()) {
+    if (left_done) {
+      return std::nullopt;
+    }
+    probeChunk();
+  }
+  auto [l, r] = pairs[pair++];
+  return concat(lefts[l], rights[r]);
+}
+
+void RadixJoin::close() {
+  Join::close();
+  rights = {};
+  slots = {};
+  table_offsets = {};
+  lefts = {};
+  pairs = {};
+  pair = 0;
+  left_done = true;
+}
+
+unsigned RadixJoin::getBits() const { return bits; }
+
+MergeJoin::MergeJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred)
+    : Join(std::move(left), std::move(right), std::move(pred)) {
+  if (this->pred.op == PredicateOp::NE) {
+    throw std::logic_error("A merge join needs an equality or an order");
+  }
+}
+
+void MergeJoin::open() {
+  current.reset();
+  run.clear();
+  next_right.reset();
+  begin = end = pos = 0;
+  left->open();
+  right->open();
+  if (pred.op == PredicateOp::EQ) {
+    next_right = right->next();
+    return;
+  }
+  while (auto t = right->next()) {
+    run.push_back(std::move(*t));
+  }
+  right->close();
+}
+
+void MergeJoin::seek(const field_t &key) {
+  auto key_of = [&](size_t i) -> const field_t & { return run[i].get_field(right_field); };
+  switch (pred.op) {
+  case PredicateOp::EQ:
+    if (run.empty() || key_of(0) != key) {
+      run.clear();
+      while (next_right && next_right->get_field(right_field) < key) {
+        next_right = right->next();
+      }
+      while (next_right && next_right->get_field(right_field) == key) {
+        run.push_back(std::move(*next_right));
+        next_right = right->next();
+      }
+    }
+    end = run.size();
+    break;
+  case PredicateOp::LT:
+    while (begin < run.size() && key_of(begin) <= key) {
+      begin++;
+    }
+    end = run.size();
+    break;
+  case PredicateOp::LE:
+    while (begin < run.size() && key_of(begin) < key) {
+      begin++;
+    }
+    end = run.size();
+    break;
+  case PredicateOp::GT:
+    while (end < run.size() && key_of(end) < key) {
+      end++;
+    }
+    break;
+  case PredicateOp::GE:
+    while (end < run.size() && key_of(end) <= key) {
+      end++;
+    }
+    break;
+  case PredicateOp::NE:
+    break;
+  }
+  pos = begin;
+}
+
+std::optional<Tuple> MergeJoin::next() {
+  while (!current || pos == end) {
+    current = left->next();
+    if (!current) {
+      return std::nullopt;
+    }
+    seek(current->get_field(left_field));
+  }
+  return concat(*current, run[pos++]);
+}
+
+void MergeJoin::close() {
+  Join::close();
+  run = {};
+  next_right.reset();
+  begin = end = pos = 0;
+}
+
+IndexJoin::IndexJoin(std::unique_ptr<Operator> left, const BTreeFile &index, JoinPredicate pred, size_t batch)
+    : Join(std::move(left), std::make_unique<Scan>(index), std::move(pred)), index(index),
+      batch(std::max<size_t>(batch, 1)) {
+  if (this->pred.op != PredicateOp::EQ || index.getKeyIndex() != right_field) {
+    throw std::logic_error("An index join needs an equality on the key of the tree");
+  }
+}
+
+bool IndexJoin::nextBatch() {
+  lefts.clear();
+  while (lefts.size() < batch) {
+    auto t = left->next();
+    if (!t) {
+      break;
+    }
+    lefts.push_back(std::move(*t));
+  }
+  // A value of another type than the int key matches no tuple
+  std::vector<int> keys;
+  for (const auto &t : lefts) {
+    if (const int *key = std::get_if<int>(&t.get_field(left_field))) {
+      keys.push_back(*key);
+    }
+  }
+  matches = index.multiGet(keys);
+  match_keys.clear();
+  for (const auto &t : matches) {
+    match_keys.push_back(index.getKeyCodec().extract(t));
+  }
+  l = 0;
+  pos = end = 0;
+  return !lefts.empty();
+}
+
+void IndexJoin::open() {
+  current.reset();
+  lefts.clear();
+  l = pos = end = 0;
+  left->open();
+}
+
+std::optional<Tuple> IndexJoin::next() {
+  while (pos == end) {
+    if (l + 1 < lefts.size()) {
+      l++;
+    } else if (!nextBatch()) {
+      return std::nullopt;
+    }
+    pos = end = 0;
+    if (const int *key = std::get_if<int>(&lefts[l].get_field(left_field))) {
+      auto [first, last] = std::equal_range(match_keys.begin(), match_keys.end(), *key);
+      pos = first - match_keys.begin();
+      end = last - match_keys.begin();
+    }
+  }
+  return concat(lefts[l], matches[pos++]);
+}
+
+void IndexJoin::close() {
+  Join::close();
+  lefts = {};
+  matches = {};
+  match_keys = {};
+  l = pos = end = 0;
+}
+
+BlockJoin::BlockJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred,
+                     size_t memory)
+    : Join(std::move(left), std::move(right), std::move(pred)), memory(memory) {}
+
+bool BlockJoin::nextBlock() {
+  const TupleDesc &left_td = left->getTupleDesc();
+  block.clear();
+  keys.clear();
+  size_t bytes = 0;
+  while (block.empty() || bytes + left_td.length() <= memory) {
+    auto t = left->next();
+    if (!t) {
+      break;
+    }
+    bytes += left_td.length();
+    if (block.size() % vec::BATCH_SIZE == 0) {
+      keys.emplace_back(left_td.type_of(left_field));
+    }
+    keys.back().push(t->get_field(left_field));
+    block.push_back(std::move(*t));
+  }
+  blocks += !block.empty();
+  return !block.empty();
+}
+
+void BlockJoin::match() {
+  static const std::vector<uint16_t> all = [] {
+    std::vector<uint16_t> rows(vec::BATCH_SIZE);
+    std::iota(rows.begin(), rows.end(), 0);
+    return rows;
+  }();
+  uint16_t selected[vec::BATCH_SIZE];
+  const field_t &value = inner->get_field(right_field);
+  matches.clear();
+  pos = 0;
+  for (size_t c = 0; c < keys.size(); c++) {
+    size_t n = std::min(vec::BATCH_SIZE, block.size() - c * vec::BATCH_SIZE);
+    size_t count = vec::select(keys[c], pred.op, value, all.data(), n, selected);
+    for (size_t i = 0; i < count; i++) {
+      matches.push_back(static_cast<uint32_t>(c * vec::BATCH_SIZE + selected[i]));
+    }
+  }
+}
+
+void BlockJoin::open() {
+  current.reset();
+  inner.reset();
+  matches.clear();
+  pos = 0;
+  blocks = 0;
+  left->open();
+  if (nextBlock()) {
+    right->open();
+  }
+}
+
+std::optional<Tuple> BlockJoin::next() {
+  while (pos == matches.size()) {
+    if (block.empty()) {
+      return std::nullopt;
+    }
+    inner = right->next();
+    if (!inner) {
+      // Read the right child again for the next block
+      right->close();
+      if (nextBlock()) {
+        right->open();
+      }
+      continue;
+    }
+    match();
+  }
+  return concat(block[matches[pos++]], *inner);
+}
+
+void BlockJoin::close() {
+  Join::close();
+  block = {};
+  keys = {};
+  inner.reset();
+  matches = {};
+  pos = 0;
+}
+
+size_t BlockJoin::getBlocks() const { return blocks; }
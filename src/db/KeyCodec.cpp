@@ -0,0 +1,121 @@
+#include <bit>
+#include <cstring>
+#include <db/KeyCodec.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+template <class T> void storeBigEndian(uint8_t *dst, T value) {
+  for (size_t i = 0; i < sizeof(T); i++) {
+    dst[i] = static_cast<uint8_t>(value >> (8 * (sizeof(T) - 1 - i)));
+  }
+}
+
+size_t fieldWidth(type_t type) {
+  switch (type) {
+  case type_t::INT:
+    return INT_SIZE;
+  case type_t::DOUBLE:
+    return DOUBLE_SIZE;
+  case type_t::CHAR:
+    return CHAR_SIZE;
+  }
+  return 0;
+}
+} // namespace
+
+NormalizedKey::NormalizedKey(const TupleDesc &td, const std::vector<size_t> &fields)
+    : fields{}, types{}, num_fields(fields.size()), width(0) {
+  if (fields.empty() || fields.size() > MAX_FIELDS) {
+    throw std::logic_error("Invalid number of key fields");
+  }
+  for (size_t i = 0; i < fields.size(); i++) {
+    if (fields[i] >= td.size()) {
+      throw std::logic_error("Key field out of range");
+    }
+    this->fields[i] = fields[i];
+    types[i] = td.type_of(fields[i]);
+    width += fieldWidth(types[i]);
+  }
+}
+
+void NormalizedKey::encode(uint8_t *dst, size_t i, const field_t &value) const {
+  switch (types[i]) {
+  case type_t::INT:
+    storeBigEndian(dst, static_cast<uint32_t>(std::get<int>(value)) ^ (1u << 31));
+    break;
+  case type_t::DOUBLE: {
+    auto bits = std::bit_cast<uint64_t>(std::get<double>(value));
+    storeBigEndian(dst, bits >> 63 ? ~bits : bits | (uint64_t{1} << 63));
+    break;
+  }
+  case type_t::CHAR:
+    strncpy(reinterpret_cast<char *>(dst), std::get<std::string>(value).c_str(), CHAR_SIZE);
+    break;
+  }
+}
+
+NormalizedKey::key_type NormalizedKey::extract(const Tuple &t) const {
+  key_type key(width, '\0');
+  auto *dst = reinterpret_cast<uint8_t *>(key.data());
+  for (size_t i = 0; i < num_fields; i++) {
+    encode(dst, i, t.get_field(fields[i]));
+    dst += fieldWidth(types[i]);
+  }
+  return key;
+}
+
+NormalizedKey::key_type NormalizedKey::encode(const std::vector<field_t> &values) const {
+  if (values.size() != num_fields) {
+    throw std::logic_error("Invalid number of key values");
+  }
+  key_type key(width, '\0');
+  auto *dst = reinterpret_cast<uint8_t *>(key.data());
+  for (size_t i = 0; i < num_fields; i++) {
+    if (Tuple({values[i]}).field_type(0) != types[i]) {
+      throw std::logic_error("Key value of the wrong type");
+    }
+    encode(dst, i, values[i]);
+    dst += fieldWidth(types[i]);
+  }
+  return key;
+}
+
+NormalizedKey::key_type NormalizedKey::load(const slot_type *key) const {
+  return {reinterpret_cast<const char *>(key), width};
+}
+
+void NormalizedKey::store(slot_type *dst, const key_type &key) const { std::memcpy(dst, key.data(), width); }
+
+int NormalizedKey::compare(const key_type &key, const slot_type *other) const {
+  return std::memcmp(key.data(), other, width);
+}
+
+size_t NormalizedKey::lower_bound(const slot_type *keys, size_t n, const key_type &key) const {
+  size_t lo = 0;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (compare(key, keys + (lo + half) * width) > 0) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return lo;
+}
+
+size_t NormalizedKey::upper_bound(const slot_type *keys, size_t n, const key_type &key) const {
+  size_t lo = 0;
+  while (n > 0) {
+    size_t half = n / 2;
+    if (compare(key, keys + (lo + half) * width) >= 0) {
+      lo += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return lo;
+}
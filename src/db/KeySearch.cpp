@@ -0,0 +1,125 @@
+#include <cstring>
+#include <db/KeySearch.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DB_SEARCH_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace db;
+
+namespace {
+/// The number of keys left for the final linear count (4 AVX2 registers)
+constexpr size_t WINDOW = 32;
+
+struct Dense {
+  const int *keys;
+
+  int operator[](size_t i) const { return keys[i]; }
+};
+
+struct Strided {
+  const uint8_t *base;
+  size_t stride;
+
+  int operator[](size_t i) const {
+    int key;
+    std::memcpy(&key, base + i * stride, sizeof(int));
+    return key;
+  }
+};
+
+template <bool upper> bool before(int k, int key) { return upper ? k <= key : k < key; }
+
+/**
+ * @brief Branchless binary search: returns `lo` such that the result lies in [lo, lo + n], and shrinks `n` to the
+ * window size. Every key before `lo` is before `key`.
+ */
+template <bool upper, class Keys> size_t narrow(const Keys &keys, size_t &n, int key) {
+  size_t lo = 0;
+  while (n > WINDOW) {
+    size_t half = n / 2;
+    lo = before<upper>(keys[lo + half], key) ? lo + half : lo;
+    n -= half;
+  }
+  return lo;
+}
+
+template <bool upper, class Keys> size_t count(const Keys &keys, size_t lo, size_t n, int key) {
+  size_t c = 0;
+  for (size_t i = 0; i < n; i++) {
+    c += before<upper>(keys[lo + i], key);
+  }
+  return c;
+}
+
+#ifdef DB_SEARCH_AVX2
+const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+template <bool upper> __attribute__((target("avx2"))) size_t countMask(__m256i k, __m256i v, __m256i valid) {
+  // lower: key > v; upper: !(v > key)
+  __m256i hit = upper ? _mm256_andnot_si256(_mm256_cmpgt_epi32(v, k), valid)
+                      : _mm256_and_si256(_mm256_cmpgt_epi32(k, v), valid);
+  return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(hit)));
+}
+
+template <bool upper> __attribute__((target("avx2"))) size_t countAvx2(const int *keys, size_t n, int key) {
+  const __m256i k = _mm256_set1_epi32(key);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  size_t c = 0;
+  for (size_t i = 0; i < n; i += 8) {
+    __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n - i)), lanes);
+    __m256i v = _mm256_maskload_epi32(keys + i, valid);
+    c += countMask<upper>(k, v, valid);
+  }
+  return c;
+}
+
+template <bool upper>
+__attribute__((target("avx2"))) size_t countAvx2(const uint8_t *base, size_t stride, size_t n, int key) {
+  const __m256i k = _mm256_set1_epi32(key);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256i offsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32(static_cast<int>(stride)));
+  size_t c = 0;
+  for (size_t i = 0; i < n; i += 8) {
+    __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n - i)), lanes);
+    const int *first = reinterpret_cast<const int *>(base + i * stride);
+    __m256i v = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), first, offsets, valid, 1);
+    c += countMask<upper>(k, v, valid);
+  }
+  return c;
+}
+#endif
+
+template <bool upper> size_t searchDense(const int *keys, size_t n, int key) {
+  size_t lo = narrow<upper>(Dense{keys}, n, key);
+#ifdef DB_SEARCH_AVX2
+  if (has_avx2) {
+    return lo + countAvx2<upper>(keys + lo, n, key);
+  }
+#endif
+  return lo + count<upper>(Dense{keys}, lo, n, key);
+}
+
+template <bool upper> size_t searchStrided(const uint8_t *base, size_t stride, size_t n, int key) {
+  size_t lo = narrow<upper>(Strided{base, stride}, n, key);
+#ifdef DB_SEARCH_AVX2
+  if (has_avx2) {
+    return lo + countAvx2<upper>(base + lo * stride, stride, n, key);
+  }
+#endif
+  return lo + count<upper>(Strided{base, stride}, lo, n, key);
+}
+} // namespace
+
+size_t search::lower_bound(const int *keys, size_t n, int key) { return searchDense<false>(keys, n, key); }
+
+size_t search::upper_bound(const int *keys, size_t n, int key) { return searchDense<true>(keys, n, key); }
+
+size_t search::lower_bound(const uint8_t *base, size_t stride, size_t n, int key) {
+  return searchStrided<false>(base, stride, n, key);
+}
+
+size_t search::upper_bound(const uint8_t *base, size_t stride, size_t n, int key) {
+  return searchStrided<true>(base, stride, n, key);
+}
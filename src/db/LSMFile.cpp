@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <climits>
+#include <db/Database.hpp>
+#include <db/LSMFile.hpp>
+#include <db/RunPage.hpp>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+
+using namespace db;
+
+namespace {
+size_t filterPages(size_t filter_size) { return (filter_size + DEFAULT_PAGE_SIZE - 1) / DEFAULT_PAGE_SIZE; }
+
+/**
+ * @brief Get the pages of a run followed by its filter
+ */
+size_t extent(const RunInfo &info) { return info.pages + filterPages(info.filter_size); }
+
+/**
+ * @brief Writes the entries of a run page by page, sequentially and directly to the file, then the filter of its keys.
+ */
+class RunWriter {
+  DbFile &file;
+  size_t bits_per_key;
+  size_t pages = 0;
+  Page page{};
+  RunPage run_page;
+  std::vector<uint64_t> hashes;
+
+  void write() {
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    PageId pid{file.getName(), first + pages};
+    // The page may be cached from a run that was merged away
+    if (bufferPool.contains(pid)) {
+      bufferPool.discardPage(pid);
+    }
+    file.writePage(page, first + pages);
+    pages++;
+    page.fill(0);
+  }
+
+  void prepare(int key) {
+    if (run_page.full()) {
+      write();
+    }
+    if (run_page.header->size == 0) {
+      fences.push_back(key);
+    }
+    if (bits_per_key != 0) {
+      hashes.push_back(BloomFilter::hash(key));
+    }
+  }
+
+public:
+  const size_t first;
+  std::vector<int> fences;
+  std::optional<BloomFilter> filter;
+
+  RunWriter(DbFile &file, size_t first, size_t bits_per_key)
+      : file(file), bits_per_key(bits_per_key), run_page(page, file.getTupleDesc()), first(first) {}
+
+  void append(int key, const Tuple *t) {
+    prepare(key);
+    run_page.append(key, t);
+  }
+
+  void append(const RunPage &other, size_t slot) {
+    prepare(other.keys[slot]);
+    run_page.append(other, slot);
+  }
+
+  /**
+   * @return the run; its filter, if any, is in `filter`
+   */
+  RunInfo finish() {
+    if (run_page.header->size != 0) {
+      write();
+    }
+    RunInfo info{first, pages, 0, 0};
+    if (hashes.empty()) {
+      return info;
+    }
+    filter.emplace(hashes.size(), bits_per_key);
+    for (uint64_t hash : hashes) {
+      filter->insert(hash);
+    }
+    info.filter_size = filter->size();
+    for (size_t offset = 0; offset < filter->size(); offset += DEFAULT_PAGE_SIZE) {
+      std::copy_n(filter->data() + offset, std::min(DEFAULT_PAGE_SIZE, filter->size() - offset), page.data());
+      write();
+    }
+    return info;
+  }
+};
+
+/**
+ * @brief Reads the entries of a run in order, page by page and directly from the file.
+ */
+struct RunCursor {
+  const DbFile &file;
+  RunInfo info;
+  size_t page = 0;
+  size_t slot = 0;
+  Page buffer;
+  RunPage run_page;
+
+  RunCursor(const DbFile &file, const RunInfo &info) : file(file), info(info), run_page(buffer, file.getTupleDesc()) {
+    file.readPage(buffer, info.first);
+  }
+
+  bool done() const { return page == info.pages; }
+
+  int key() const { return run_page.keys[slot]; }
+
+  void advance() {
+    if (++slot < run_page.header->size) {
+      return;
+    }
+    slot = 0;
+    if (++page < info.pages) {
+      file.readPage(buffer, info.first + page);
+    }
+  }
+};
+} // namespace
+
+LSMFile::LSMFile(const std::string &name, const TupleDesc &td, size_t key_index, size_t memtable_pages,
+                 size_t bloom_bits_per_key)
+    : DbFile(name, td), key_index(key_index), memtable_pages(memtable_pages), bloom_bits_per_key(bloom_bits_per_key) {
+  if (td.type_of(key_index) != type_t::INT) {
+    throw std::logic_error("Key must be an int");
+  }
+  Page page{};
+  memtable_capacity = memtable_pages * RunPage(page, td).capacity;
+  if (numPages == 1) {
+    return;
+  }
+  readPage(page, 0);
+  const auto *header = reinterpret_cast<const LSMFileHeader *>(page.data());
+  for (size_t i = 0; i < header->num_runs; i++) {
+    Run run{header->runs[i], {}, {}};
+    written.push_back(run.info);
+    Page buffer;
+    for (size_t p = 0; p < run.info.pages; p++) {
+      readPage(buffer, run.info.first + p);
+      run.fences.push_back(RunPage(buffer, td).keys[0]);
+    }
+    if (run.info.filter_size != 0) {
+      std::vector<uint8_t> filter(filterPages(run.info.filter_size) * DEFAULT_PAGE_SIZE);
+      for (size_t p = 0; p < filterPages(run.info.filter_size); p++) {
+        readPage(buffer, run.info.first + run.info.pages + p);
+        std::copy(buffer.begin(), buffer.end(), filter.begin() + p * DEFAULT_PAGE_SIZE);
+      }
+      run.filter.emplace(filter.data(), run.info.filter_size);
+    }
+    runs.push_back(std::move(run));
+  }
+}
+
+size_t LSMFile::runPages(size_t entries) const {
+  size_t capacity = memtable_capacity / memtable_pages;
+  size_t pages = (entries + capacity - 1) / capacity;
+  if (bloom_bits_per_key != 0 && entries != 0) {
+    pages += filterPages(BloomFilter::sizeFor(entries, bloom_bits_per_key));
+  }
+  return pages;
+}
+
+size_t LSMFile::allocate(size_t pages) {
+  std::vector<std::pair<size_t, size_t>> used;
+  for (const auto &run : runs) {
+    used.emplace_back(run.info.first, run.info.first + extent(run.info));
+  }
+  // A crash before the next header must still find the runs of the current one
+  for (const auto &info : written) {
+    used.emplace_back(info.first, info.first + extent(info));
+  }
+  std::sort(used.begin(), used.end());
+  size_t first = 1;
+  for (const auto &[begin, end] : used) {
+    if (begin >= first + pages) {
+      break;
+    }
+    first = std::max(first, end);
+  }
+  numPages = std::max(numPages, first + pages);
+  return first;
+}
+
+void LSMFile::writeHeader() {
+  Page page{};
+  auto *header = reinterpret_cast<LSMFileHeader *>(page.data());
+  header->num_runs = runs.size();
+  written.clear();
+  for (size_t i = 0; i < runs.size(); i++) {
+    header->runs[i] = runs[i].info;
+    written.push_back(runs[i].info);
+  }
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  if (bufferPool.contains({name, 0})) {
+    bufferPool.discardPage({name, 0});
+  }
+  writePage(page, 0);
+}
+
+void LSMFile::flush() {
+  if (memtable.empty()) {
+    return;
+  }
+  RunWriter writer(*this, allocate(runPages(memtable.size())), bloom_bits_per_key);
+  for (const auto &[key, t] : memtable) {
+    // A tombstone only hides older entries, so the first run does not need it
+    if (t || !runs.empty()) {
+      writer.append(key, t ? &*t : nullptr);
+    }
+  }
+  memtable.clear();
+  RunInfo info = writer.finish();
+  if (info.pages != 0) {
+    runs.insert(runs.begin(), Run{info, std::move(writer.fences), std::move(writer.filter)});
+  }
+  auto l0_runs = std::count_if(runs.begin(), runs.end(), [](const Run &run) { return run.info.level == 0; });
+  if (static_cast<size_t>(l0_runs) >= L0_RUNS) {
+    compact(0);
+  }
+  writeHeader();
+}
+
+void LSMFile::compact(size_t level) {
+  // The runs of the level and of the next level are contiguous in `runs`, from the newest
+  auto first = std::find_if(runs.begin(), runs.end(), [&](const Run &run) { return run.info.level >= level; });
+  auto last = std::find_if(first, runs.end(), [&](const Run &run) { return run.info.level > level + 1; });
+  bool bottom = last == runs.end();
+  std::vector<std::unique_ptr<RunCursor>> cursors;
+  size_t pages = 0;
+  for (auto it = first; it != last; ++it) {
+    cursors.push_back(std::make_unique<RunCursor>(*this, it->info));
+    pages += it->info.pages;
+  }
+
+  // Merge the runs; of the entries with the same key, the one of the newest run (the smallest cursor) comes first
+  RunWriter writer(*this, allocate(runPages(pages * (memtable_capacity / memtable_pages))), bloom_bits_per_key);
+  using Entry = std::pair<int, size_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap;
+  for (size_t i = 0; i < cursors.size(); i++) {
+    heap.emplace(cursors[i]->key(), i);
+  }
+  auto advance = [&](size_t i) {
+    cursors[i]->advance();
+    if (!cursors[i]->done()) {
+      heap.emplace(cursors[i]->key(), i);
+    }
+  };
+  while (!heap.empty()) {
+    auto [key, i] = heap.top();
+    heap.pop();
+    const RunCursor &cursor = *cursors[i];
+    if (!bottom || !cursor.run_page.tombstones[cursor.slot]) {
+      writer.append(cursor.run_page, cursor.slot);
+    }
+    advance(i);
+    while (!heap.empty() && heap.top().first == key) {
+      size_t older = heap.top().second;
+      heap.pop();
+      advance(older);
+    }
+  }
+
+  RunInfo info = writer.finish();
+  auto pos = runs.erase(first, last);
+  if (info.pages == 0) {
+    return;
+  }
+  info.level = level + 1;
+  runs.insert(pos, Run{info, std::move(writer.fences), std::move(writer.filter)});
+  size_t limit = memtable_pages * L0_RUNS;
+  for (size_t i = 1; i <= level; i++) {
+    limit *= LEVEL_FANOUT;
+  }
+  if (info.pages > limit) {
+    compact(level + 1);
+  }
+}
+
+std::optional<size_t> LSMFile::findPage(const Run &run, int key) {
+  auto it = std::upper_bound(run.fences.begin(), run.fences.end(), key);
+  if (it == run.fences.begin()) {
+    return std::nullopt;
+  }
+  return it - run.fences.begin() - 1;
+}
+
+std::optional<std::optional<Tuple>> LSMFile::findEntry(int key) const {
+  if (auto it = memtable.find(key); it != memtable.end()) {
+    return it->second;
+  }
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  uint64_t hash = BloomFilter::hash(key);
+  for (const auto &run : runs) {
+    std::optional<size_t> page = findPage(run, key);
+    if (!page || (run.filter && !bloom_stats.count(run.filter->mayContain(hash)))) {
+      continue;
+    }
+    PageGuard guard(bufferPool, {name, run.info.first + *page});
+    RunPage run_page(guard.page, td);
+    size_t slot = run_page.lower_bound(key);
+    if (slot < run_page.header->size && run_page.keys[slot] == key) {
+      if (run_page.tombstones[slot]) {
+        return std::optional<Tuple>();
+      }
+      return run_page.getTuple(slot);
+    }
+    if (run.filter) {
+      bloom_stats.addFalsePositive();
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<int> LSMFile::successor(int key, bool inclusive) const {
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  while (true) {
+    std::optional<int> best;
+    auto consider = [&](int candidate) {
+      if (!best || candidate < *best) {
+        best = candidate;
+      }
+    };
+    auto it = inclusive ? memtable.lower_bound(key) : memtable.upper_bound(key);
+    if (it != memtable.end()) {
+      consider(it->first);
+    }
+    for (const auto &run : runs) {
+      size_t page = findPage(run, key).value_or(0);
+      PageGuard guard(bufferPool, {name, run.info.first + page});
+      RunPage run_page(guard.page, td);
+      size_t slot = inclusive ? run_page.lower_bound(key) : run_page.upper_bound(key);
+      if (slot < run_page.header->size) {
+        consider(run_page.keys[slot]);
+      } else if (page + 1 < run.info.pages) {
+        consider(run.fences[page + 1]);
+      }
+    }
+    if (!best || *findEntry(*best)) {
+      return best;
+    }
+    // The newest entry of the key is a tombstone
+    key = *best;
+    inclusive = false;
+  }
+}
+
+Iterator LSMFile::position(std::optional<int> key) const {
+  if (!key) {
+    return end();
+  }
+  return {*this, 0, static_cast<size_t>(*key)};
+}
+
+void LSMFile::insertTuple(const Tuple &t) {
+  if (!td.compatible(t)) {
+    throw std::runtime_error("Tuple not compatible with TupleDesc");
+  }
+  memtable.insert_or_assign(std::get<int>(t.get_field(key_index)), t);
+  if (memtable.size() >= memtable_capacity) {
+    flush();
+  }
+}
+
+void LSMFile::deleteTuple(const Iterator &it) {
+  memtable.insert_or_assign(static_cast<int>(it.slot), std::nullopt);
+  if (memtable.size() >= memtable_capacity) {
+    flush();
+  }
+}
+
+Tuple LSMFile::getTuple(const Iterator &it) const {
+  std::optional<Tuple> t = lookup(static_cast<int>(it.slot));
+  if (!t) {
+    throw std::out_of_range("No tuple with this key");
+  }
+  return *t;
+}
+
+void LSMFile::next(Iterator &it) const {
+  Iterator found = position(successor(static_cast<int>(it.slot), false));
+  it.page = found.page;
+  it.slot = found.slot;
+}
+
+Iterator LSMFile::begin() const { return position(successor(INT_MIN, true)); }
+
+Iterator LSMFile::end() const { return {*this, 1, 0}; }
+
+std::optional<Tuple> LSMFile::lookup(int key) const { return findEntry(key).value_or(std::nullopt); }
+
+std::vector<RunInfo> LSMFile::getRuns() const {
+  std::vector<RunInfo> result;
+  for (const auto &run : runs) {
+    result.push_back(run.info);
+  }
+  return result;
+}
+
+BloomStats LSMFile::getBloomStats() const { return bloom_stats.get(); }
+
+size_t LSMFile::getKeyIndex() const { return key_index; }
@@ -1,30 +1,117 @@
+#include <algorithm>
 #include <db/LeafPage.hpp>
 #include <stdexcept>
 
 using namespace db;
 
-LeafPage::LeafPage(Page &page, const TupleDesc &td, size_t key_index) : td(td), key_index(key_index) {
+template <class K>
+BasicLeafPage<K>::BasicLeafPage(Page &page, const TupleDesc &td, const K &codec) : td(td), codec(codec) {
+  size_t width = codec.stride() * sizeof(slot_type);
   header = reinterpret_cast<LeafPageHeader *>(page.data());
-  capacity = (DEFAULT_PAGE_SIZE - sizeof(LeafPageHeader)) / td.length();
+  capacity = (DEFAULT_PAGE_SIZE - sizeof(LeafPageHeader) - width) / (td.length() + width + sizeof(uint16_t));
+  high_key = reinterpret_cast<slot_type *>(header + 1);
+  keys = high_key + codec.stride();
+  slots = reinterpret_cast<uint16_t *>(keys + capacity * codec.stride());
   data = page.data() + DEFAULT_PAGE_SIZE - td.length() * capacity;
 }
 
-bool LeafPage::insertTuple(const Tuple &t) {
-  return false;
+template <class K> bool BasicLeafPage<K>::insertTuple(const Tuple &t, bool unique) {
+  key_type key = codec.extract(t);
+  size_t stride = codec.stride();
+  size_t pos = unique ? lower_bound(key) : upper_bound(key);
+  if (!unique || pos == header->size || codec.compare(key, keys + pos * stride) != 0) {
+    std::move_backward(keys + pos * stride, keys + header->size * stride, keys + (header->size + 1) * stride);
+    std::move_backward(slots + pos, slots + header->size, slots + header->size + 1);
+    codec.store(keys + pos * stride, key);
+    slots[pos] = header->size;
+    header->size++;
+  }
+  td.serialize(data + slots[pos] * td.length(), t);
+  return header->size == capacity;
+}
+
+template <class K> void BasicLeafPage<K>::deleteTuple(size_t slot) {
+  if (slot >= header->size) {
+    throw std::out_of_range("slot out of range");
+  }
+  size_t length = td.length();
+  size_t stride = codec.stride();
+  size_t pos = slots[slot];
+  size_t last = header->size - 1;
+  if (pos != last) {
+    std::copy_n(data + last * length, length, data + pos * length);
+    *std::find(slots, slots + header->size, last) = pos;
+  }
+  std::move(keys + (slot + 1) * stride, keys + header->size * stride, keys + slot * stride);
+  std::move(slots + slot + 1, slots + header->size, slots + slot);
+  header->size--;
 }
 
-int LeafPage::split(LeafPage &new_page) {
-  size_t half = header->size / 2;
+template <class K> typename K::key_type BasicLeafPage<K>::split(BasicLeafPage &new_page, double fill) {
+  size_t half = std::clamp<size_t>(header->size * fill, 1, header->size - 1);
+  size_t length = td.length();
+  size_t stride = codec.stride();
   new_page.header->size = header->size - half;
   new_page.header->next_leaf = header->next_leaf;
-  std::copy(data + half * td.length(), data + header->size * td.length(), new_page.data);
+  std::copy_n(high_key, stride, new_page.high_key);
+  std::copy(keys + half * stride, keys + header->size * stride, new_page.keys);
+  for (size_t i = half; i < header->size; i++) {
+    new_page.slots[i - half] = i - half;
+    std::copy_n(data + slots[i] * length, length, new_page.data + (i - half) * length);
+  }
+
+  // Tuples of the first half stored past position `half` are moved to the positions freed by the second half
+  std::vector<bool> used(half);
+  for (size_t i = 0; i < half; i++) {
+    if (slots[i] < half) {
+      used[slots[i]] = true;
+    }
+  }
+  size_t free = 0;
+  for (size_t i = 0; i < half; i++) {
+    if (slots[i] >= half) {
+      while (used[free]) {
+        free++;
+      }
+      std::copy_n(data + slots[i] * length, length, data + free * length);
+      slots[i] = free++;
+    }
+  }
   header->size = half;
-  return std::get<int>(td.deserialize(new_page.data).get_field(key_index));
+  std::copy_n(new_page.keys, stride, high_key);
+  return getHighKey();
+}
+
+template <class K> bool BasicLeafPage<K>::pastHighKey(const key_type &key, bool lower) const {
+  return header->next_leaf != 0 && codec.compare(key, high_key) >= (lower ? 1 : 0);
 }
 
-Tuple LeafPage::getTuple(size_t slot) const {
+template <class K> Tuple BasicLeafPage<K>::getTuple(size_t slot) const {
   if (slot >= header->size) {
     throw std::out_of_range("slot out of range");
   }
-  return td.deserialize(data + slot * td.length());
+  return td.deserialize(data + slots[slot] * td.length());
+}
+
+template <class K> typename K::key_type BasicLeafPage<K>::getKey(size_t slot) const {
+  return codec.load(keys + slot * codec.stride());
+}
+
+template <class K> typename K::key_type BasicLeafPage<K>::getHighKey() const { return codec.load(high_key); }
+
+template <class K> void BasicLeafPage<K>::setHighKey(const key_type &key) { codec.store(high_key, key); }
+
+template <class K> size_t BasicLeafPage<K>::lower_bound(const key_type &key) const {
+  return codec.lower_bound(keys, header->size, key);
+}
+
+template <class K> size_t BasicLeafPage<K>::lower_bound(const key_type &key, size_t lo, size_t hi) const {
+  return lo + codec.lower_bound(keys + lo * codec.stride(), hi - lo, key);
 }
+
+template <class K> size_t BasicLeafPage<K>::upper_bound(const key_type &key) const {
+  return codec.upper_bound(keys, header->size, key);
+}
+
+template struct db::BasicLeafPage<IntKey>;
+template struct db::BasicLeafPage<NormalizedKey>;
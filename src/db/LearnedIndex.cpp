@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cmath>
+#include <db/LearnedIndex.hpp>
+#include <limits>
+
+using namespace db;
+
+LearnedIndex::LearnedIndex(size_t max_error) : max_error(max_error) {}
+
+void LearnedIndex::add(int key, size_t pos) {
+  if (!segments.empty()) {
+    Segment &segment = segments.back();
+    double dx = static_cast<double>(key) - segment.key;
+    double dy = static_cast<double>(pos) - static_cast<double>(segment.pos);
+    double error = static_cast<double>(max_error);
+    double lo = std::max(min_slope, (dy - error) / dx);
+    double hi = std::min(max_slope, (dy + error) / dx);
+    if (lo <= hi) {
+      min_slope = lo;
+      max_slope = hi;
+      segment.slope = (lo + hi) / 2;
+      return;
+    }
+  }
+  segments.push_back({key, pos, 0});
+  min_slope = 0;
+  max_slope = std::numeric_limits<double>::infinity();
+}
+
+void LearnedIndex::finish(size_t n) { size = n; }
+
+std::pair<size_t, size_t> LearnedIndex::search(int key) const {
+  auto it = std::upper_bound(segments.begin(), segments.end(), key,
+                             [](int k, const Segment &segment) { return k < segment.key; });
+  if (it == segments.begin()) {
+    return {0, std::min(size, max_error + 2)};
+  }
+  size_t next = it == segments.end() ? size : it->pos;
+  const Segment &segment = *--it;
+  double predicted = static_cast<double>(segment.pos) + segment.slope * (static_cast<double>(key) - segment.key);
+  // Keys between the last point of a segment and the next segment belong to the first position of the next segment
+  auto pos = std::clamp(static_cast<size_t>(std::max(0.0, std::floor(predicted))), segment.pos, next);
+  // One more position on each side absorbs the rounding of the prediction
+  return {pos > max_error + 1 ? pos - max_error - 1 : 0, std::min(size, pos + max_error + 2)};
+}
+
+size_t LearnedIndex::getSegments() const { return segments.size(); }
+
+size_t LearnedIndex::getBytes() const { return segments.size() * sizeof(Segment); }
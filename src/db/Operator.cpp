@@ -0,0 +1,502 @@
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <db/BTreeFile.hpp>
+#include <db/BTreeIndex.hpp>
+#include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <db/HeapFile.hpp>
+#include <db/HeapPage.hpp>
+#include <db/Operator.hpp>
+#include <db/PageFilter.hpp>
+#include <db/Predicate.hpp>
+#include <numeric>
+#include <stdexcept>
+
+using namespace db;
+using namespace db::op;
+
+namespace {
+/**
+ * @brief Get the range of an int field implied by the predicates on it.
+ * @return the inclusive bounds, kept wider than int so that the bounds of GT INT_MAX / LT INT_MIN do not overflow
+ */
+std::pair<long long, long long> fieldRange(const TupleDesc &td, size_t field, const std::vector<FilterPredicate> &pred) {
+  long long lo = INT_MIN;
+  long long hi = INT_MAX;
+  for (const auto &p : pred) {
+    if (td.index_of(p.field_name) != field || !std::holds_alternative<int>(p.value)) {
+      continue;
+    }
+    long long v = std::get<int>(p.value);
+    switch (p.op) {
+    case PredicateOp::EQ:
+      lo = std::max(lo, v);
+      hi = std::min(hi, v);
+      break;
+    case PredicateOp::LT:
+      hi = std::min(hi, v - 1);
+      break;
+    case PredicateOp::LE:
+      hi = std::min(hi, v);
+      break;
+    case PredicateOp::GT:
+      lo = std::max(lo, v + 1);
+      break;
+    case PredicateOp::GE:
+      lo = std::max(lo, v);
+      break;
+    case PredicateOp::NE:
+      break;
+    }
+  }
+  return {lo, hi};
+}
+
+/**
+ * @brief Get the tuples of a BTreeFile with keys in an inclusive range.
+ */
+Morsel treeRange(const BTreeFile &file, std::pair<long long, long long> range) {
+  auto [lo, hi] = range;
+  if (lo > hi) {
+    return {file.end(), file.end()};
+  }
+  Iterator first = lo == INT_MIN ? file.begin() : file.lower_bound(static_cast<int>(lo));
+  Iterator last = hi == INT_MAX ? file.end() : file.upper_bound(static_cast<int>(hi));
+  return {first, last};
+}
+
+/**
+ * @brief Find a secondary index of a HeapFile over a field that the predicates restrict to a range.
+ * @param range set to the inclusive range of the indexed field
+ * @return the index, or nullptr if there is none
+ */
+const BTreeIndex *findIndex(const HeapFile &file, const std::vector<FilterPredicate> &pred,
+                            std::pair<long long, long long> &range) {
+  const TupleDesc &td = file.getTupleDesc();
+  for (const auto &p : pred) {
+    const BTreeIndex *index = file.getIndex(td.index_of(p.field_name));
+    if (!index) {
+      continue;
+    }
+    range = fieldRange(td, index->getField(), pred);
+    if (range.first != INT_MIN || range.second != INT_MAX) {
+      return index;
+    }
+  }
+  return nullptr;
+}
+
+Tuple project(const Tuple &t, const std::vector<size_t> &fields) {
+  std::vector<field_t> values;
+  values.reserve(fields.size());
+  for (size_t field : fields) {
+    values.push_back(t.get_field(field));
+  }
+  return values;
+}
+
+/**
+ * @brief Get a name for a new field that is not used by the other fields.
+ * @return the name, or else the name followed by `.1`, `.2`, ...
+ */
+std::string uniqueName(const std::vector<std::string> &names, const std::string &name) {
+  std::string result = name;
+  for (size_t i = 1; std::find(names.begin(), names.end(), result) != names.end(); i++) {
+    result = name + "." + std::to_string(i);
+  }
+  return result;
+}
+
+std::vector<size_t> indexes(const TupleDesc &td, const std::vector<std::string> &names) {
+  std::vector<size_t> result;
+  for (const auto &name : names) {
+    result.push_back(td.index_of(name));
+  }
+  return result;
+}
+} // namespace
+
+TupleDesc op::projectDesc(const TupleDesc &td, const std::vector<size_t> &fields) {
+  std::vector<type_t> types;
+  std::vector<std::string> names;
+  for (size_t field : fields) {
+    types.push_back(td.type_of(field));
+    names.push_back(uniqueName(names, td.name_of(field)));
+  }
+  return {types, names};
+}
+
+TupleDesc op::aggregateDesc(const TupleDesc &td, const db::Aggregate &agg) {
+  std::vector<type_t> types;
+  std::vector<std::string> names;
+  if (agg.group) {
+    types.push_back(td.type_of(td.index_of(*agg.group)));
+    names.push_back(*agg.group);
+  }
+  switch (agg.op) {
+  case AggregateOp::COUNT:
+    types.push_back(type_t::INT);
+    break;
+  case AggregateOp::AVG:
+    types.push_back(type_t::DOUBLE);
+    break;
+  default:
+    types.push_back(td.type_of(td.index_of(agg.field)));
+  }
+  static const char *const OP_NAMES[] = {"sum", "avg", "min", "max", "count"};
+  names.push_back(std::string(OP_NAMES[static_cast<size_t>(agg.op)]) + "(" + agg.field + ")");
+  return {types, names};
+}
+
+Scan::Scan(const DbFile &file, const std::vector<std::string> &field_names, std::vector<FilterPredicate> pred)
+    : file(file), pred(std::move(pred)) {
+  const TupleDesc &file_td = file.getTupleDesc();
+  if (field_names.empty()) {
+    fields.resize(file_td.size());
+    std::iota(fields.begin(), fields.end(), 0);
+  } else {
+    fields = indexes(file_td, field_names);
+  }
+  td = projectDesc(file_td, fields);
+  if (!dynamic_cast<const HeapFile *>(&file)) {
+    return;
+  }
+  std::vector<FilterPredicate> rest;
+  for (size_t i = 0; i < this->pred.size(); i++) {
+    const FilterPredicate &p = this->pred[i];
+    size_t field = file_td.index_of(p.field_name);
+    if ((file_td.type_of(field) == type_t::INT && std::holds_alternative<int>(p.value)) ||
+        (file_td.type_of(field) == type_t::DOUBLE && std::holds_alternative<double>(p.value))) {
+      page_pred.push_back(i);
+      page_fields.push_back(field);
+    } else {
+      rest.push_back(p);
+    }
+  }
+  page_rest = CompiledPredicate(file_td, rest);
+}
+
+const TupleDesc &Scan::getTupleDesc() const { return td; }
+
+void Scan::open() {
+  close();
+  const TupleDesc &file_td = file.getTupleDesc();
+  read = fields;
+  // An equality on the key of a HashFile only reads the bucket of the key
+  if (const auto *hash = dynamic_cast<const HashFile *>(&file)) {
+    for (const auto &p : pred) {
+      if (p.op == PredicateOp::EQ && file_td.index_of(p.field_name) == hash->getKeyIndex()) {
+        tuples = hash->findAll(p.value);
+        return;
+      }
+    }
+  }
+  const auto *heap = dynamic_cast<const HeapFile *>(&file);
+  std::pair<long long, long long> range;
+  if (const BTreeIndex *index = heap ? heap->getCoveringIndex(fields) : nullptr) {
+    // Read the fields from the entries of the index instead of the file
+    range = fieldRange(file_td, index->getField(), pred);
+    morsel.emplace(range.first <= range.second
+                       ? index->entries(static_cast<int>(range.first), static_cast<int>(range.second))
+                       : Morsel{index->end(), index->end()});
+    for (size_t &field : read) {
+      field = index->entryField(field);
+    }
+  } else if (const BTreeIndex *index = heap ? findIndex(*heap, pred, range) : nullptr) {
+    // Fetch the tuples of the index range in record id order
+    if (range.first <= range.second) {
+      rids = index->rids(file, static_cast<int>(range.first), static_cast<int>(range.second));
+    }
+    return;
+  } else if (const auto *tree = dynamic_cast<const BTreeFile *>(&file)) {
+    morsel.emplace(treeRange(*tree, fieldRange(file_td, tree->getKeyIndex(), pred)));
+  } else if (heap && !pred.empty()) {
+    page = 0;
+    return;
+  } else {
+    morsel.emplace(Morsel{file.begin(), file.end()});
+  }
+  it.emplace(morsel->first);
+}
+
+std::optional<Tuple> Scan::next() {
+  if (morsel) {
+    if (*it == morsel->last) {
+      return std::nullopt;
+    }
+    Tuple t = project(**it, read);
+    ++*it;
+    return t;
+  }
+  if (pos < rids.size()) {
+    return project(file.getTuple(rids[pos++]), read);
+  }
+  while (page && pos == tuples.size() && *page < file.getNumPages()) {
+    readPage();
+  }
+  if (pos < tuples.size()) {
+    return project(tuples[pos++], read);
+  }
+  return std::nullopt;
+}
+
+void Scan::readPage() {
+  const TupleDesc &file_td = file.getTupleDesc();
+  PageGuard guard(getDatabase().getBufferPool(), {file.getName(), (*page)++});
+  const HeapPage hp(guard.page, file_td);
+  uint64_t bits[pagefilter::words(DEFAULT_PAGE_SIZE)];
+  hp.occupied(bits);
+  const uint8_t *first = hp.getBytes(0);
+  for (size_t i = 0; i < page_pred.size(); i++) {
+    const FilterPredicate &p = pred[page_pred[i]];
+    const uint8_t *base = first + file_td.offset_of(page_fields[i]);
+    size_t selected = std::holds_alternative<int>(p.value)
+                          ? pagefilter::select(base, file_td.length(), hp.end(), p.op, std::get<int>(p.value), bits)
+                          : pagefilter::select(base, file_td.length(), hp.end(), p.op, std::get<double>(p.value), bits);
+    if (selected == 0) {
+      break;
+    }
+  }
+  tuples.clear();
+  pos = 0;
+  for (size_t w = 0; w < pagefilter::words(hp.end()); w++) {
+    for (uint64_t word = bits[w]; word; word &= word - 1) {
+      size_t slot = w * 64 + std::countr_zero(word);
+      if (page_rest(hp.getBytes(slot))) {
+        tuples.push_back(hp.getTuple(slot));
+      }
+    }
+  }
+}
+
+void Scan::close() {
+  tuples.clear();
+  rids.clear();
+  pos = 0;
+  page.reset();
+  it.reset();
+  morsel.reset();
+}
+
+Filter::Filter(std::unique_ptr<Operator> child, const std::vector<FilterPredicate> &pred, EvalMode mode,
+               const CompiledPredicate::Stats &stats)
+    : child(std::move(child)), pred(this->child->getTupleDesc(), pred, mode, stats) {}
+
+const TupleDesc &Filter::getTupleDesc() const { return child->getTupleDesc(); }
+
+void Filter::open() { child->open(); }
+
+std::optional<Tuple> Filter::next() {
+  while (auto t = child->next()) {
+    if (pred(*t)) {
+      return t;
+    }
+  }
+  return std::nullopt;
+}
+
+void Filter::close() { child->close(); }
+
+Project::Project(std::unique_ptr<Operator> child, const std::vector<std::string> &field_names)
+    : child(std::move(child)) {
+  const TupleDesc &child_td = this->child->getTupleDesc();
+  fields = indexes(child_td, field_names);
+  td = projectDesc(child_td, fields);
+}
+
+const TupleDesc &Project::getTupleDesc() const { return td; }
+
+void Project::open() { child->open(); }
+
+std::optional<Tuple> Project::next() {
+  std::optional<Tuple> t = child->next();
+  if (!t) {
+    return std::nullopt;
+  }
+  return project(*t, fields);
+}
+
+void Project::close() { child->close(); }
+
+Join::Join(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred)
+    : left(std::move(left)), right(std::move(right)), pred(std::move(pred)) {
+  const TupleDesc &left_td = this->left->getTupleDesc();
+  const TupleDesc &right_td = this->right->getTupleDesc();
+  left_field = left_td.index_of(this->pred.left);
+  right_field = right_td.index_of(this->pred.right);
+  std::vector<type_t> types;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < left_td.size(); i++) {
+    types.push_back(left_td.type_of(i));
+    names.push_back(left_td.name_of(i));
+  }
+  for (size_t i = 0; i < right_td.size(); i++) {
+    if (this->pred.op == PredicateOp::EQ && i == right_field) {
+      continue;
+    }
+    types.push_back(right_td.type_of(i));
+    names.push_back(uniqueName(names, right_td.name_of(i)));
+  }
+  td = {types, names};
+}
+
+Tuple Join::concat(const Tuple &l, const Tuple &r) const {
+  std::vector<field_t> values;
+  values.reserve(td.size());
+  for (size_t i = 0; i < l.size(); i++) {
+    values.push_back(l.get_field(i));
+  }
+  for (size_t i = 0; i < r.size(); i++) {
+    if (pred.op != PredicateOp::EQ || i != right_field) {
+      values.push_back(r.get_field(i));
+    }
+  }
+  return values;
+}
+
+const TupleDesc &Join::getTupleDesc() const { return td; }
+
+void Join::open() {
+  table.clear();
+  current.reset();
+  left->open();
+  if (pred.op != PredicateOp::EQ) {
+    return;
+  }
+  right->open();
+  while (auto t = right->next()) {
+    field_t key = t->get_field(right_field);
+    table.emplace(std::move(key), std::move(*t));
+  }
+  right->close();
+  match = match_end = table.end();
+}
+
+std::optional<Tuple> Join::next() {
+  if (pred.op == PredicateOp::EQ) {
+    while (match == match_end) {
+      current = left->next();
+      if (!current) {
+        return std::nullopt;
+      }
+      std::tie(match, match_end) = table.equal_range(current->get_field(left_field));
+    }
+    return concat(*current, (match++)->second);
+  }
+  while (true) {
+    if (!current) {
+      current = left->next();
+      if (!current) {
+        return std::nullopt;
+      }
+      right->open();
+    }
+    while (auto r = right->next()) {
+      if (compare(current->get_field(left_field), pred.op, r->get_field(right_field))) {
+        return concat(*current, *r);
+      }
+    }
+    right->close();
+    current.reset();
+  }
+}
+
+void Join::close() {
+  left->close();
+  right->close();
+  table.clear();
+  current.reset();
+}
+
+void op::Aggregate::Accumulator::add(const field_t &v, AggregateOp op) {
+  if (count++ == 0) {
+    value = v;
+    return;
+  }
+  switch (op) {
+  case AggregateOp::SUM:
+  case AggregateOp::AVG:
+    if (std::holds_alternative<int>(v)) {
+      value = std::get<int>(value) + std::get<int>(v);
+    } else if (std::holds_alternative<double>(v)) {
+      value = std::get<double>(value) + std::get<double>(v);
+    } else {
+      throw std::logic_error("Cannot sum a CHAR field");
+    }
+    break;
+  case AggregateOp::MIN:
+    value = std::min(value, v);
+    break;
+  case AggregateOp::MAX:
+    value = std::max(value, v);
+    break;
+  case AggregateOp::COUNT:
+    break;
+  }
+}
+
+field_t op::Aggregate::Accumulator::result(AggregateOp op) const {
+  switch (op) {
+  case AggregateOp::COUNT:
+    return count;
+  case AggregateOp::AVG:
+    return (std::holds_alternative<int>(value) ? std::get<int>(value) : std::get<double>(value)) / double(count);
+  default:
+    return value;
+  }
+}
+
+op::Aggregate::Aggregate(std::unique_ptr<Operator> child, db::Aggregate agg)
+    : child(std::move(child)), agg(std::move(agg)) {
+  const TupleDesc &child_td = this->child->getTupleDesc();
+  field = child_td.index_of(this->agg.field);
+  if (this->agg.group) {
+    group = child_td.index_of(*this->agg.group);
+  }
+  td = aggregateDesc(child_td, this->agg);
+}
+
+const TupleDesc &op::Aggregate::getTupleDesc() const { return td; }
+
+void op::Aggregate::open() {
+  groups.clear();
+  child->open();
+  while (auto t = child->next()) {
+    groups[group ? t->get_field(*group) : field_t{}].add(t->get_field(field), agg.op);
+  }
+  child->close();
+  // COUNT of no rows is a single 0, while the other aggregates of no rows have no value
+  empty_count = !group && groups.empty() && agg.op == AggregateOp::COUNT;
+  pos = groups.begin();
+}
+
+std::optional<Tuple> op::Aggregate::next() {
+  if (empty_count) {
+    empty_count = false;
+    return Tuple({0});
+  }
+  if (pos == groups.end()) {
+    return std::nullopt;
+  }
+  const auto &[key, acc] = *pos++;
+  if (group) {
+    return Tuple({key, acc.result(agg.op)});
+  }
+  return Tuple({acc.result(agg.op)});
+}
+
+void op::Aggregate::close() { groups.clear(); }
+
+Sink::Sink(std::unique_ptr<Operator> child, DbFile &out) : child(std::move(child)), out(out) {}
+
+size_t Sink::run() {
+  size_t count = 0;
+  child->open();
+  while (auto t = child->next()) {
+    out.insertTuple(*t);
+    count++;
+  }
+  child->close();
+  return count;
+}
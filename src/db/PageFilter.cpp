@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <db/PageFilter.hpp>
+#include <db/Predicate.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DB_PAGEFILTER_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace db;
+
+namespace {
+template <PredicateOp op, typename T>
+size_t selectScalar(const uint8_t *base, size_t stride, size_t n, T value, uint64_t *bits) {
+  size_t count = 0;
+  for (size_t w = 0; w < pagefilter::words(n); w++) {
+    if (!bits[w]) {
+      continue;
+    }
+    uint64_t word = 0;
+    size_t end = std::min<size_t>(64, n - w * 64);
+    for (size_t j = 0; j < end; j++) {
+      T v;
+      std::memcpy(&v, base + (w * 64 + j) * stride, sizeof(T));
+      word |= static_cast<uint64_t>(compare<op>(v, value)) << j;
+    }
+    bits[w] &= word;
+    count += std::popcount(bits[w]);
+  }
+  return count;
+}
+
+#ifdef DB_PAGEFILTER_AVX2
+const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+template <PredicateOp op> __attribute__((target("avx2"))) __m256i compareLanes(__m256i v, __m256i k) {
+  const __m256i ones = _mm256_set1_epi32(-1);
+  switch (op) {
+  case PredicateOp::EQ:
+    return _mm256_cmpeq_epi32(v, k);
+  case PredicateOp::NE:
+    return _mm256_xor_si256(_mm256_cmpeq_epi32(v, k), ones);
+  case PredicateOp::LT:
+    return _mm256_cmpgt_epi32(k, v);
+  case PredicateOp::LE:
+    return _mm256_xor_si256(_mm256_cmpgt_epi32(v, k), ones);
+  case PredicateOp::GT:
+    return _mm256_cmpgt_epi32(v, k);
+  case PredicateOp::GE:
+    return _mm256_xor_si256(_mm256_cmpgt_epi32(k, v), ones);
+  }
+  return _mm256_setzero_si256();
+}
+
+/// The ordered comparisons are false for NaN, and NE is true, like the C++ operators
+template <PredicateOp op> __attribute__((target("avx2"))) __m256d compareLanes(__m256d v, __m256d k) {
+  switch (op) {
+  case PredicateOp::EQ:
+    return _mm256_cmp_pd(v, k, _CMP_EQ_OQ);
+  case PredicateOp::NE:
+    return _mm256_cmp_pd(v, k, _CMP_NEQ_UQ);
+  case PredicateOp::LT:
+    return _mm256_cmp_pd(v, k, _CMP_LT_OQ);
+  case PredicateOp::LE:
+    return _mm256_cmp_pd(v, k, _CMP_LE_OQ);
+  case PredicateOp::GT:
+    return _mm256_cmp_pd(v, k, _CMP_GT_OQ);
+  case PredicateOp::GE:
+    return _mm256_cmp_pd(v, k, _CMP_GE_OQ);
+  }
+  return _mm256_setzero_pd();
+}
+
+/**
+ * @brief Only the selected slots of a group of 8 are gathered; the bits of the slots past `n` are clear, so the group
+ * never reads past the last slot.
+ */
+template <PredicateOp op>
+__attribute__((target("avx2"))) size_t selectAvx2(const uint8_t *base, size_t stride, size_t n, int value,
+                                                  uint64_t *bits) {
+  const __m256i k = _mm256_set1_epi32(value);
+  const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m256i offsets =
+      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+  size_t count = 0;
+  for (size_t w = 0; w < pagefilter::words(n); w++) {
+    uint64_t word = 0;
+    for (size_t j = 0; j < 64 && bits[w] >> j; j += 8) {
+      int wanted = static_cast<int>(bits[w] >> j & 0xFF);
+      if (!wanted) {
+        continue;
+      }
+      __m256i valid = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(wanted), lanes), lanes);
+      const int *first = reinterpret_cast<const int *>(base + (w * 64 + j) * stride);
+      __m256i v = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), first, offsets, valid, 1);
+      word |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(compareLanes<op>(v, k)))) << j;
+    }
+    bits[w] &= word;
+    count += std::popcount(bits[w]);
+  }
+  return count;
+}
+
+template <PredicateOp op>
+__attribute__((target("avx2"))) size_t selectAvx2(const uint8_t *base, size_t stride, size_t n, double value,
+                                                  uint64_t *bits) {
+  const __m256d k = _mm256_set1_pd(value);
+  const __m256i lanes = _mm256_setr_epi64x(1, 2, 4, 8);
+  const __m128i offsets = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(stride)));
+  size_t count = 0;
+  for (size_t w = 0; w < pagefilter::words(n); w++) {
+    uint64_t word = 0;
+    for (size_t j = 0; j < 64 && bits[w] >> j; j += 4) {
+      long long wanted = static_cast<long long>(bits[w] >> j & 0xF);
+      if (!wanted) {
+        continue;
+      }
+      __m256i valid = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(wanted), lanes), lanes);
+      const double *first = reinterpret_cast<const double *>(base + (w * 64 + j) * stride);
+      __m256d v = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), first, offsets, _mm256_castsi256_pd(valid), 1);
+      word |= static_cast<uint64_t>(_mm256_movemask_pd(compareLanes<op>(v, k))) << j;
+    }
+    bits[w] &= word;
+    count += std::popcount(bits[w]);
+  }
+  return count;
+}
+#endif
+
+template <PredicateOp op, typename T>
+size_t selectOp(const uint8_t *base, size_t stride, size_t n, T value, uint64_t *bits) {
+#ifdef DB_PAGEFILTER_AVX2
+  if (has_avx2) {
+    return selectAvx2<op>(base, stride, n, value, bits);
+  }
+#endif
+  return selectScalar<op>(base, stride, n, value, bits);
+}
+
+template <typename T>
+size_t selectValue(const uint8_t *base, size_t stride, size_t n, PredicateOp op, T value, uint64_t *bits) {
+  switch (op) {
+  case PredicateOp::EQ:
+    return selectOp<PredicateOp::EQ>(base, stride, n, value, bits);
+  case PredicateOp::NE:
+    return selectOp<PredicateOp::NE>(base, stride, n, value, bits);
+  case PredicateOp::LT:
+    return selectOp<PredicateOp::LT>(base, stride, n, value, bits);
+  case PredicateOp::LE:
+    return selectOp<PredicateOp::LE>(base, stride, n, value, bits);
+  case PredicateOp::GT:
+    return selectOp<PredicateOp::GT>(base, stride, n, value, bits);
+  case PredicateOp::GE:
+    return selectOp<PredicateOp::GE>(base, stride, n, value, bits);
+  }
+  return 0;
+}
+} // namespace
+
+size_t pagefilter::select(const uint8_t *base, size_t stride, size_t n, PredicateOp op, int value, uint64_t *bits) {
+  return selectValue(base, stride, n, op, value, bits);
+}
+
+size_t pagefilter::select(const uint8_t *base, size_t stride, size_t n, PredicateOp op, double value, uint64_t *bits) {
+  return selectValue(base, stride, n, op, value, bits);
+}
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cstring>
+#include <db/Predicate.hpp>
+#include <limits>
+#include <numeric>
+#include <string_view>
+
+using namespace db;
+
+namespace {
+template <typename T, typename Term> const T &valueOf(const Term &term) {
+  if constexpr (std::is_same_v<T, int>) {
+    return term.int_value;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return term.double_value;
+  } else {
+    return term.char_value;
+  }
+}
+
+template <typename Term, typename T, PredicateOp op> bool evalTuple(const Tuple &t, const Term &term) {
+  return compare<op>(std::get<T>(t.get_field(term.field)), valueOf<T>(term));
+}
+
+template <typename Term, typename T, PredicateOp op> bool evalBytes(const uint8_t *data, const Term &term) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    const char *chars = reinterpret_cast<const char *>(data + term.offset);
+    return compare<op>(std::string_view(chars, strnlen(chars, CHAR_SIZE)), std::string_view(term.char_value));
+  } else {
+    T v;
+    std::memcpy(&v, data + term.offset, sizeof(T));
+    return compare<op>(v, valueOf<T>(term));
+  }
+}
+
+template <typename Term, typename T, PredicateOp op> void bind(Term &term) {
+  term.tuple = evalTuple<Term, T, op>;
+  term.bytes = evalBytes<Term, T, op>;
+}
+
+template <typename Term, typename T> void bind(Term &term, PredicateOp op) {
+  switch (op) {
+  case PredicateOp::EQ:
+    return bind<Term, T, PredicateOp::EQ>(term);
+  case PredicateOp::NE:
+    return bind<Term, T, PredicateOp::NE>(term);
+  case PredicateOp::LT:
+    return bind<Term, T, PredicateOp::LT>(term);
+  case PredicateOp::LE:
+    return bind<Term, T, PredicateOp::LE>(term);
+  case PredicateOp::GT:
+    return bind<Term, T, PredicateOp::GT>(term);
+  case PredicateOp::GE:
+    return bind<Term, T, PredicateOp::GE>(term);
+  }
+}
+
+field_t zero(type_t type) {
+  switch (type) {
+  case type_t::INT:
+    return 0;
+  case type_t::DOUBLE:
+    return 0.0;
+  default:
+    return std::string();
+  }
+}
+
+/**
+ * @brief Estimate the fraction of the tuples that satisfy a predicate.
+ */
+double selectivity(const FilterPredicate &p, const CompiledPredicate::Stats &stats) {
+  auto it = stats.find(p.field_name);
+  if (it != stats.end() && std::holds_alternative<int>(p.value)) {
+    int v = std::get<int>(p.value);
+    // EQ and NE split the values in two
+    double n = it->second.estimateCardinality(PredicateOp::EQ, v) + it->second.estimateCardinality(PredicateOp::NE, v);
+    if (n > 0) {
+      return it->second.estimateCardinality(p.op, v) / n;
+    }
+  }
+  switch (p.op) {
+  case PredicateOp::EQ:
+    return 0.1;
+  case PredicateOp::NE:
+    return 0.9;
+  default:
+    return 1.0 / 3;
+  }
+}
+} // namespace
+
+bool db::compare(const field_t &lhs, PredicateOp op, const field_t &rhs) {
+  switch (op) {
+  case PredicateOp::EQ:
+    return lhs == rhs;
+  case PredicateOp::NE:
+    return lhs != rhs;
+  case PredicateOp::LT:
+    return lhs < rhs;
+  case PredicateOp::LE:
+    return lhs <= rhs;
+  case PredicateOp::GT:
+    return lhs > rhs;
+  case PredicateOp::GE:
+    return lhs >= rhs;
+  }
+  return false;
+}
+
+CompiledPredicate::CompiledPredicate(const TupleDesc &td, const std::vector<FilterPredicate> &pred, EvalMode mode,
+                                     const Stats &stats)
+    : mode(mode) {
+  std::vector<double> ranks;
+  for (size_t i = 0; i < pred.size(); i++) {
+    const FilterPredicate &p = pred[i];
+    Term term;
+    term.field = td.index_of(p.field_name);
+    term.offset = td.offset_of(term.field);
+    type_t type = td.type_of(term.field);
+    if (p.value.index() != zero(type).index()) {
+      // Every value of the field compares the same way with a value of another type
+      never |= !compare(zero(type), p.op, p.value);
+      continue;
+    }
+    double cost = 1;
+    switch (type) {
+    case type_t::INT:
+      term.int_value = std::get<int>(p.value);
+      bind<Term, int>(term, p.op);
+      break;
+    case type_t::DOUBLE:
+      term.double_value = std::get<double>(p.value);
+      bind<Term, double>(term, p.op);
+      break;
+    case type_t::CHAR:
+      term.char_value = std::get<std::string>(p.value);
+      bind<Term, std::string>(term, p.op);
+      cost = 4;
+      break;
+    }
+    double rejected = 1 - selectivity(p, stats);
+    ranks.push_back(rejected > 0 ? cost / rejected : std::numeric_limits<double>::infinity());
+    terms.push_back(std::move(term));
+    order.push_back(i);
+  }
+
+  std::vector<size_t> sorted(terms.size());
+  std::iota(sorted.begin(), sorted.end(), 0);
+  std::stable_sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+  std::vector<Term> sorted_terms;
+  std::vector<size_t> sorted_order;
+  for (size_t i : sorted) {
+    sorted_terms.push_back(std::move(terms[i]));
+    sorted_order.push_back(order[i]);
+  }
+  terms = std::move(sorted_terms);
+  order = std::move(sorted_order);
+}
+
+template <typename F> bool CompiledPredicate::evaluate(F eval) const {
+  if (never) {
+    return false;
+  }
+  if (mode == EvalMode::SHORT_CIRCUIT) {
+    for (const auto &term : terms) {
+      if (!eval(term)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool result = true;
+  for (const auto &term : terms) {
+    result &= eval(term);
+  }
+  return result;
+}
+
+bool CompiledPredicate::operator()(const Tuple &t) const {
+  return evaluate([&](const Term &term) { return term.tuple(t, term); });
+}
+
+bool CompiledPredicate::operator()(const uint8_t *data) const {
+  return evaluate([&](const Term &term) { return term.bytes(data, term); });
+}
+
+const std::vector<size_t> &CompiledPredicate::getOrder() const { return order; }
@@ -1,19 +1,167 @@
+#include <algorithm>
+#include <db/BTreeFile.hpp>
+#include <db/BufferPool.hpp>
+#include <db/Join.hpp>
+#include <db/Operator.hpp>
 #include <db/Query.hpp>
+#include <db/TempFile.hpp>
+#include <memory>
+#include <queue>
+#include <stdexcept>
 
 using namespace db;
 
+namespace {
+constexpr size_t SORT_BUFFER_PAGES = DEFAULT_NUM_PAGES / 2;
+constexpr size_t SORT_FAN_IN = DEFAULT_NUM_PAGES / 2;
+
+/**
+ * @brief Merge sorted runs into the out table.
+ */
+void merge(const std::vector<const DbFile *> &runs, DbFile &out, size_t field) {
+  std::vector<Iterator> its;
+  std::vector<std::optional<Tuple>> heads;
+  using Entry = std::pair<field_t, size_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+  for (size_t i = 0; i < runs.size(); i++) {
+    its.push_back(runs[i]->begin());
+    heads.emplace_back();
+    if (its[i] != runs[i]->end()) {
+      heads[i] = *its[i];
+      queue.emplace(heads[i]->get_field(field), i);
+    }
+  }
+  while (!queue.empty()) {
+    size_t i = queue.top().second;
+    queue.pop();
+    out.insertTuple(*heads[i]);
+    if (++its[i] != runs[i]->end()) {
+      heads[i] = *its[i];
+      queue.emplace(heads[i]->get_field(field), i);
+    }
+  }
+}
+
+bool sortedOn(const DbFile &file, const std::string &field) {
+  const auto *tree = dynamic_cast<const BTreeFile *>(&file);
+  return tree && tree->getKeyIndex() == file.getTupleDesc().index_of(field);
+}
+
+/**
+ * @brief Scan a file in ascending order of a field: the file itself if it is a BTreeFile keyed on the field, and
+ * otherwise a sorted copy in a temporary file, which is added to `temps`.
+ */
+std::unique_ptr<op::Operator> sortedScan(const DbFile &file, const std::string &field,
+                                         std::vector<std::unique_ptr<TempFile>> &temps) {
+  if (sortedOn(file, field)) {
+    return std::make_unique<op::Scan>(file);
+  }
+  temps.push_back(std::make_unique<TempFile>(file.getName() + ".sorted", file.getTupleDesc()));
+  db::sort(file, temps.back()->file(), field);
+  return std::make_unique<op::Scan>(temps.back()->file());
+}
+} // namespace
+
 void db::projection(const DbFile &in, DbFile &out, const std::vector<std::string> &field_names) {
-  // TODO: Implement this function
+  op::Sink(std::make_unique<op::Scan>(in, field_names), out).run();
 }
 
 void db::filter(const DbFile &in, DbFile &out, const std::vector<FilterPredicate> &pred) {
-  // TODO: Implement this function
+  op::Sink(std::make_unique<op::Filter>(std::make_unique<op::Scan>(in, std::vector<std::string>{}, pred), pred), out)
+      .run();
 }
 
 void db::aggregate(const DbFile &in, DbFile &out, const Aggregate &agg) {
-  // TODO: Implement this function
+  std::vector<std::string> fields{agg.field};
+  if (agg.group) {
+    fields.push_back(*agg.group);
+  }
+  op::Sink(std::make_unique<op::Aggregate>(std::make_unique<op::Scan>(in, fields), agg), out).run();
 }
 
 void db::join(const DbFile &left, const DbFile &right, DbFile &out, const JoinPredicate &pred) {
-  // TODO: Implement this function
+  const TupleDesc &left_td = left.getTupleDesc();
+  // Looking up the left values reads at most a leaf per left tuple, instead of every page of the tree
+  size_t left_tuples = left.getNumPages() * (DEFAULT_PAGE_SIZE / left_td.length());
+  if (pred.op == PredicateOp::EQ && sortedOn(right, pred.right) &&
+      left_td.type_of(left_td.index_of(pred.left)) == type_t::INT && left_tuples <= right.getNumPages()) {
+    auto l = std::make_unique<op::Scan>(left);
+    op::Sink(std::make_unique<op::IndexJoin>(std::move(l), dynamic_cast<const BTreeFile &>(right), pred), out).run();
+    return;
+  }
+  bool sorted = sortedOn(left, pred.left) && sortedOn(right, pred.right);
+  // The merge join of an order holds the whole right table in memory, so it only runs when the table fits the budget
+  bool fits = right.getNumPages() * DEFAULT_PAGE_SIZE <= op::DEFAULT_JOIN_MEMORY;
+  if ((pred.op == PredicateOp::EQ && sorted) || (pred.op != PredicateOp::EQ && pred.op != PredicateOp::NE && fits)) {
+    std::vector<std::unique_ptr<TempFile>> temps;
+    auto l = sortedScan(left, pred.left, temps);
+    auto r = sortedScan(right, pred.right, temps);
+    op::Sink(std::make_unique<op::MergeJoin>(std::move(l), std::move(r), pred), out).run();
+    return;
+  }
+  auto l = std::make_unique<op::Scan>(left);
+  auto r = std::make_unique<op::Scan>(right);
+  // The radix join holds the whole right table in memory, so it only runs when the table fits the join budget
+  if (pred.op == PredicateOp::EQ && right.getNumPages() * DEFAULT_PAGE_SIZE <= op::DEFAULT_JOIN_MEMORY) {
+    op::Sink(std::make_unique<op::RadixJoin>(std::move(l), std::move(r), pred), out).run();
+  } else if (pred.op == PredicateOp::EQ) {
+    op::Sink(std::make_unique<op::HashJoin>(std::move(l), std::move(r), pred), out).run();
+  } else {
+    op::Sink(std::make_unique<op::BlockJoin>(std::move(l), std::move(r), pred), out).run();
+  }
+}
+
+void db::sort(const DbFile &in, DbFile &out, const std::string &field) {
+  const TupleDesc &td = in.getTupleDesc();
+  size_t index = td.index_of(field);
+  size_t chunk = SORT_BUFFER_PAGES * DEFAULT_PAGE_SIZE / td.length();
+
+  std::vector<std::unique_ptr<TempFile>> runs;
+  std::vector<Tuple> buffer;
+  auto sortBuffer = [&] {
+    std::stable_sort(buffer.begin(), buffer.end(),
+                     [&](const Tuple &a, const Tuple &b) { return a.get_field(index) < b.get_field(index); });
+  };
+  auto spill = [&] {
+    sortBuffer();
+    runs.push_back(std::make_unique<TempFile>(in.getName() + ".run", td));
+    for (const auto &t : buffer) {
+      runs.back()->file().insertTuple(t);
+    }
+    buffer.clear();
+  };
+  for (const auto &t : in) {
+    buffer.push_back(t);
+    if (buffer.size() == chunk) {
+      spill();
+    }
+  }
+  if (runs.empty()) {
+    sortBuffer();
+    for (const auto &t : buffer) {
+      out.insertTuple(t);
+    }
+    return;
+  }
+  if (!buffer.empty()) {
+    spill();
+  }
+
+  while (runs.size() > SORT_FAN_IN) {
+    std::vector<std::unique_ptr<TempFile>> merged;
+    for (size_t i = 0; i < runs.size(); i += SORT_FAN_IN) {
+      std::vector<const DbFile *> group;
+      for (size_t j = i; j < std::min(i + SORT_FAN_IN, runs.size()); j++) {
+        group.push_back(&runs[j]->file());
+      }
+      merged.push_back(std::make_unique<TempFile>(in.getName() + ".run", td));
+      merge(group, merged.back()->file(), index);
+    }
+    runs = std::move(merged);
+  }
+  std::vector<const DbFile *> group;
+  for (const auto &run : runs) {
+    group.push_back(&run->file());
+  }
+  merge(group, out, index);
 }
@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <db/KeySearch.hpp>
+#include <db/RunPage.hpp>
+#include <stdexcept>
+
+using namespace db;
+
+RunPage::RunPage(Page &page, const TupleDesc &td) : td(td) {
+  header = reinterpret_cast<RunPageHeader *>(page.data());
+  capacity = (DEFAULT_PAGE_SIZE - sizeof(int)) / (td.length() + sizeof(int) + sizeof(uint8_t));
+  keys = reinterpret_cast<int *>(page.data() + sizeof(int));
+  tombstones = reinterpret_cast<uint8_t *>(keys + capacity);
+  data = page.data() + DEFAULT_PAGE_SIZE - td.length() * capacity;
+}
+
+void RunPage::append(int key, const Tuple *t) {
+  keys[header->size] = key;
+  tombstones[header->size] = t == nullptr;
+  if (t != nullptr) {
+    td.serialize(data + header->size * td.length(), *t);
+  }
+  header->size++;
+}
+
+void RunPage::append(const RunPage &other, size_t slot) {
+  size_t length = td.length();
+  keys[header->size] = other.keys[slot];
+  tombstones[header->size] = other.tombstones[slot];
+  std::copy_n(other.data + slot * length, length, data + header->size * length);
+  header->size++;
+}
+
+Tuple RunPage::getTuple(size_t slot) const {
+  if (slot >= header->size) {
+    throw std::out_of_range("slot out of range");
+  }
+  return td.deserialize(data + slot * td.length());
+}
+
+size_t RunPage::lower_bound(int key) const { return search::lower_bound(keys, header->size, key); }
+
+size_t RunPage::upper_bound(int key) const { return search::upper_bound(keys, header->size, key); }
@@ -0,0 +1,23 @@
+#include <atomic>
+#include <cstdio>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/TempFile.hpp>
+
+using namespace db;
+
+TempFile::TempFile(const std::string &prefix, const TupleDesc &td) {
+  static std::atomic<size_t> counter{0};
+  name = prefix + ".tmp" + std::to_string(counter++);
+  std::remove(name.c_str());
+  getDatabase().add(std::make_unique<HeapFile>(name, td));
+}
+
+TempFile::~TempFile() {
+  Database &db = getDatabase();
+  db.getBufferPool().discardFile(name);
+  db.remove(name);
+  std::remove(name.c_str());
+}
+
+DbFile &TempFile::file() const { return getDatabase().get(name); }
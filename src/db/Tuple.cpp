@@ -67,6 +67,17 @@ size_t TupleDesc::offset_of(const size_t &index) const { return offsets.at(index
 
 size_t TupleDesc::index_of(const std::string &name) const { return name_to_index.at(name); }
 
+const std::string &TupleDesc::name_of(size_t index) const {
+  for (const auto &[name, i] : name_to_index) {
+    if (i == index) {
+      return name;
+    }
+  }
+  throw std::out_of_range("Field index out of range");
+}
+
+type_t TupleDesc::type_of(size_t index) const { return types.at(index); }
+
 size_t TupleDesc::length() const {
   size_t length = 0;
   for (type_t type : types) {
@@ -0,0 +1,556 @@
+#include <algorithm>
+#include <compare>
+#include <cstring>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/HeapPage.hpp>
+#include <db/Vector.hpp>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+using namespace db;
+using namespace db::vec;
+
+namespace {
+template <typename T> std::vector<T> &valuesOf(Column &column) {
+  if constexpr (std::is_same_v<T, int>) {
+    return column.ints;
+  } else if constexpr (std::is_same_v<T, double>) {
+    return column.doubles;
+  } else {
+    return column.chars;
+  }
+}
+
+template <typename T> const std::vector<T> &valuesOf(const Column &column) {
+  return valuesOf<T>(const_cast<Column &>(column));
+}
+
+/**
+ * @brief Call a function with the values of a column as its typed array.
+ */
+template <typename F> decltype(auto) withValues(const Column &column, F &&f) {
+  switch (column.type) {
+  case type_t::INT:
+    return f(column.ints);
+  case type_t::DOUBLE:
+    return f(column.doubles);
+  default:
+    return f(column.chars);
+  }
+}
+
+/// The index in field_t of the values of a type
+size_t variantIndex(type_t type) {
+  switch (type) {
+  case type_t::INT:
+    return 0;
+  case type_t::DOUBLE:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+bool satisfies(std::strong_ordering order, PredicateOp op) {
+  switch (op) {
+  case PredicateOp::EQ:
+    return order == 0;
+  case PredicateOp::NE:
+    return order != 0;
+  case PredicateOp::LT:
+    return order < 0;
+  case PredicateOp::LE:
+    return order <= 0;
+  case PredicateOp::GT:
+    return order > 0;
+  case PredicateOp::GE:
+    return order >= 0;
+  }
+  return false;
+}
+
+/**
+ * @brief Select the rows whose value compares to a constant without branching on the outcome.
+ * @details When the rows are every row of the column from the first one, the comparisons are a loop over the array
+ * that the compiler vectorizes, followed by the compaction of the selection vector.
+ */
+template <typename T, typename Cmp>
+size_t selectRows(const std::vector<T> &data, const T &value, const uint16_t *sel, size_t n, uint16_t *out) {
+  Cmp cmp;
+  size_t k = 0;
+  if constexpr (!std::is_same_v<T, std::string>) {
+    if (n > 0 && sel[n - 1] == n - 1) {
+      uint8_t mask[BATCH_SIZE];
+      for (size_t i = 0; i < n; i++) {
+        mask[i] = cmp(data[i], value);
+      }
+      for (size_t i = 0; i < n; i++) {
+        out[k] = static_cast<uint16_t>(i);
+        k += mask[i];
+      }
+      return k;
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    uint16_t row = sel[i];
+    out[k] = row;
+    k += cmp(data[row], value);
+  }
+  return k;
+}
+
+template <typename T>
+size_t selectRows(const std::vector<T> &data, PredicateOp op, const T &value, const uint16_t *sel, size_t n,
+                  uint16_t *out) {
+  switch (op) {
+  case PredicateOp::EQ:
+    return selectRows<T, std::equal_to<T>>(data, value, sel, n, out);
+  case PredicateOp::NE:
+    return selectRows<T, std::not_equal_to<T>>(data, value, sel, n, out);
+  case PredicateOp::LT:
+    return selectRows<T, std::less<T>>(data, value, sel, n, out);
+  case PredicateOp::LE:
+    return selectRows<T, std::less_equal<T>>(data, value, sel, n, out);
+  case PredicateOp::GT:
+    return selectRows<T, std::greater<T>>(data, value, sel, n, out);
+  case PredicateOp::GE:
+    return selectRows<T, std::greater_equal<T>>(data, value, sel, n, out);
+  }
+  return 0;
+}
+
+/**
+ * @brief Combine the selected values of a column into a single value.
+ */
+template <typename T, typename F> T reduce(const std::vector<T> &data, const uint16_t *sel, size_t n, T acc, F f) {
+  if (n > 0 && sel[n - 1] == n - 1) {
+    for (size_t i = 0; i < n; i++) {
+      acc = f(acc, data[i]);
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      acc = f(acc, data[sel[i]]);
+    }
+  }
+  return acc;
+}
+
+/**
+ * @brief Combine each selected value of a column into the value of its group.
+ */
+template <typename T, typename F>
+void reduceGroups(const std::vector<T> &data, const uint16_t *sel, const uint32_t *gids, size_t n, T *acc, F f) {
+  for (size_t i = 0; i < n; i++) {
+    T &a = acc[gids[i]];
+    a = f(a, data[sel[i]]);
+  }
+}
+} // namespace
+
+Column::Column(type_t type) : type(type) {}
+
+void Column::clear() {
+  ints.clear();
+  doubles.clear();
+  chars.clear();
+}
+
+void Column::push(const field_t &value) {
+  withValues(*this, [&](const auto &values) {
+    using T = typename std::decay_t<decltype(values)>::value_type;
+    valuesOf<T>(*this).push_back(std::get<T>(value));
+  });
+}
+
+field_t Column::get(size_t row) const {
+  return withValues(*this, [&](const auto &values) -> field_t { return values[row]; });
+}
+
+void Batch::reset(const TupleDesc &td) {
+  bool same = columns.size() == td.size();
+  for (size_t i = 0; same && i < columns.size(); i++) {
+    same = columns[i].type == td.type_of(i);
+  }
+  if (same) {
+    for (auto &column : columns) {
+      column.clear();
+    }
+  } else {
+    columns.clear();
+    for (size_t i = 0; i < td.size(); i++) {
+      columns.emplace_back(td.type_of(i));
+    }
+  }
+  sel.clear();
+  rows = 0;
+}
+
+void Batch::selectAll() {
+  sel.resize(rows);
+  std::iota(sel.begin(), sel.end(), 0);
+}
+
+size_t vec::select(const Column &column, PredicateOp op, const field_t &value, const uint16_t *sel, size_t n,
+                   uint16_t *out) {
+  // Values of different types compare by the index of their type, like variants do
+  if (value.index() != variantIndex(column.type)) {
+    if (!satisfies(variantIndex(column.type) <=> value.index(), op)) {
+      return 0;
+    }
+    std::memmove(out, sel, n * sizeof(uint16_t));
+    return n;
+  }
+  return withValues(column, [&](const auto &values) {
+    using T = typename std::decay_t<decltype(values)>::value_type;
+    return selectRows(values, op, std::get<T>(value), sel, n, out);
+  });
+}
+
+Scan::Scan(const DbFile &file, const std::vector<std::string> &field_names) : file(file) {
+  const TupleDesc &file_td = file.getTupleDesc();
+  if (field_names.empty()) {
+    fields.resize(file_td.size());
+    std::iota(fields.begin(), fields.end(), 0);
+  } else {
+    for (const auto &name : field_names) {
+      fields.push_back(file_td.index_of(name));
+    }
+  }
+  td = op::projectDesc(file_td, fields);
+}
+
+const TupleDesc &Scan::getTupleDesc() const { return td; }
+
+void Scan::open() {
+  close();
+  if (!dynamic_cast<const HeapFile *>(&file)) {
+    it.emplace(file.begin());
+  }
+}
+
+bool Scan::next(Batch &batch) {
+  batch.reset(td);
+  if (it) {
+    for (; batch.rows < BATCH_SIZE && *it != file.end(); ++*it) {
+      Tuple t = **it;
+      for (size_t i = 0; i < fields.size(); i++) {
+        batch.columns[i].push(t.get_field(fields[i]));
+      }
+      batch.rows++;
+    }
+    batch.selectAll();
+    return batch.rows > 0;
+  }
+
+  const TupleDesc &file_td = file.getTupleDesc();
+  BufferPool &bufferPool = getDatabase().getBufferPool();
+  const uint8_t *tuples[BATCH_SIZE];
+  while (batch.rows < BATCH_SIZE && page < file.getNumPages()) {
+    PageGuard guard(bufferPool, {file.getName(), page});
+    const HeapPage hp(guard.page, file_td);
+    // Collect the tuples of the page that fit in the batch, then copy their fields one column at a time
+    size_t n = 0;
+    for (slot = slot.value_or(hp.begin()); *slot != hp.end() && batch.rows + n < BATCH_SIZE; hp.next(*slot)) {
+      tuples[n++] = hp.getBytes(*slot);
+    }
+    for (size_t i = 0; i < fields.size(); i++) {
+      size_t offset = file_td.offset_of(fields[i]);
+      withValues(batch.columns[i], [&](const auto &values) {
+        using T = typename std::decay_t<decltype(values)>::value_type;
+        auto &column = valuesOf<T>(batch.columns[i]);
+        for (size_t j = 0; j < n; j++) {
+          if constexpr (std::is_same_v<T, std::string>) {
+            column.emplace_back(reinterpret_cast<const char *>(tuples[j] + offset));
+          } else {
+            T value;
+            std::memcpy(&value, tuples[j] + offset, sizeof(T));
+            column.push_back(value);
+          }
+        }
+      });
+    }
+    batch.rows += n;
+    if (*slot == hp.end()) {
+      page++;
+      slot.reset();
+    }
+  }
+  batch.selectAll();
+  return batch.rows > 0;
+}
+
+void Scan::close() {
+  page = 0;
+  slot.reset();
+  it.reset();
+}
+
+Filter::Filter(std::unique_ptr<Operator> child, std::vector<FilterPredicate> pred)
+    : child(std::move(child)), pred(std::move(pred)) {
+  for (const auto &p : this->pred) {
+    fields.push_back(this->child->getTupleDesc().index_of(p.field_name));
+  }
+}
+
+const TupleDesc &Filter::getTupleDesc() const { return child->getTupleDesc(); }
+
+void Filter::open() { child->open(); }
+
+bool Filter::next(Batch &batch) {
+  while (child->next(batch)) {
+    size_t n = batch.sel.size();
+    for (size_t i = 0; i < pred.size() && n > 0; i++) {
+      n = select(batch.columns[fields[i]], pred[i].op, pred[i].value, batch.sel.data(), n, batch.sel.data());
+    }
+    batch.sel.resize(n);
+    if (n > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Filter::close() { child->close(); }
+
+Project::Project(std::unique_ptr<Operator> child, const std::vector<std::string> &field_names)
+    : child(std::move(child)) {
+  const TupleDesc &child_td = this->child->getTupleDesc();
+  for (const auto &name : field_names) {
+    fields.push_back(child_td.index_of(name));
+  }
+  td = op::projectDesc(child_td, fields);
+}
+
+const TupleDesc &Project::getTupleDesc() const { return td; }
+
+void Project::open() { child->open(); }
+
+bool Project::next(Batch &batch) {
+  batch.reset(td);
+  if (!child->next(input)) {
+    return false;
+  }
+  // The last copy of a column takes its values, the other copies duplicate them
+  for (size_t i = 0; i < fields.size(); i++) {
+    Column &column = input.columns[fields[i]];
+    if (std::find(fields.begin() + i + 1, fields.end(), fields[i]) == fields.end()) {
+      std::swap(batch.columns[i], column);
+    } else {
+      batch.columns[i] = column;
+    }
+  }
+  std::swap(batch.sel, input.sel);
+  batch.rows = input.rows;
+  return true;
+}
+
+void Project::close() { child->close(); }
+
+vec::Aggregate::Aggregate(std::unique_ptr<Operator> child, db::Aggregate agg)
+    : child(std::move(child)), agg(std::move(agg)) {
+  const TupleDesc &child_td = this->child->getTupleDesc();
+  field = child_td.index_of(this->agg.field);
+  if (this->agg.group) {
+    group = child_td.index_of(*this->agg.group);
+  }
+  td = op::aggregateDesc(child_td, this->agg);
+}
+
+const TupleDesc &vec::Aggregate::getTupleDesc() const { return td; }
+
+void vec::Aggregate::assign(const Batch &batch, std::vector<uint32_t> &gids) {
+  const Column &values_column = batch.columns[field];
+  // A new group starts with the value of its first row, or with 0 for a sum
+  auto add = [&](uint16_t row) {
+    counts.push_back(0);
+    std::visit(
+        [&](auto &vals) {
+          using V = typename std::decay_t<decltype(vals)>::value_type;
+          bool sum = agg.op == AggregateOp::SUM || agg.op == AggregateOp::AVG;
+          vals.push_back(sum ? V{} : valuesOf<V>(values_column)[row]);
+        },
+        values);
+  };
+  if (!group) {
+    if (counts.empty()) {
+      keys.emplace_back();
+      add(batch.sel[0]);
+    }
+    return;
+  }
+  gids.resize(batch.sel.size());
+  std::visit(
+      [&](auto &groups) {
+        using K = typename std::decay_t<decltype(groups)>::key_type;
+        const auto &column = valuesOf<K>(batch.columns[*group]);
+        for (size_t i = 0; i < batch.sel.size(); i++) {
+          uint16_t row = batch.sel[i];
+          auto [it, added] = groups.try_emplace(column[row], static_cast<uint32_t>(keys.size()));
+          if (added) {
+            keys.emplace_back(column[row]);
+            add(row);
+          }
+          gids[i] = it->second;
+        }
+      },
+      ids);
+}
+
+void vec::Aggregate::accumulate(const Batch &batch, const std::vector<uint32_t> &gids) {
+  const uint16_t *sel = batch.sel.data();
+  size_t n = batch.sel.size();
+  if (group) {
+    for (size_t i = 0; i < n; i++) {
+      counts[gids[i]]++;
+    }
+  } else {
+    counts[0] += static_cast<int>(n);
+  }
+  if (agg.op == AggregateOp::COUNT) {
+    return;
+  }
+  std::visit(
+      [&](auto &vals) {
+        using V = typename std::decay_t<decltype(vals)>::value_type;
+        const auto &data = valuesOf<V>(batch.columns[field]);
+        auto run = [&](auto f) {
+          if (group) {
+            reduceGroups(data, sel, gids.data(), n, vals.data(), f);
+          } else {
+            vals[0] = reduce(data, sel, n, vals[0], f);
+          }
+        };
+        switch (agg.op) {
+        case AggregateOp::SUM:
+        case AggregateOp::AVG:
+          if constexpr (std::is_same_v<V, std::string>) {
+            throw std::logic_error("Cannot sum a CHAR field");
+          } else {
+            run([](V a, V b) { return a + b; });
+          }
+          break;
+        case AggregateOp::MIN:
+          run([](const V &a, const V &b) { return b < a ? b : a; });
+          break;
+        case AggregateOp::MAX:
+          run([](const V &a, const V &b) { return a < b ? b : a; });
+          break;
+        case AggregateOp::COUNT:
+          break;
+        }
+      },
+      values);
+}
+
+field_t vec::Aggregate::result(uint32_t gid) const {
+  if (agg.op == AggregateOp::COUNT) {
+    return counts[gid];
+  }
+  return std::visit(
+      [&](const auto &vals) -> field_t {
+        using V = typename std::decay_t<decltype(vals)>::value_type;
+        if constexpr (!std::is_same_v<V, std::string>) {
+          if (agg.op == AggregateOp::AVG) {
+            return vals[gid] / double(counts[gid]);
+          }
+        }
+        return vals[gid];
+      },
+      values);
+}
+
+void vec::Aggregate::open() {
+  close();
+  const TupleDesc &child_td = child->getTupleDesc();
+  switch (group ? child_td.type_of(*group) : type_t::INT) {
+  case type_t::INT:
+    ids.emplace<Groups<int>>();
+    break;
+  case type_t::DOUBLE:
+    ids.emplace<Groups<double>>();
+    break;
+  case type_t::CHAR:
+    ids.emplace<Groups<std::string>>();
+    break;
+  }
+  values.emplace<std::vector<int>>();
+  if (child_td.type_of(field) == type_t::DOUBLE) {
+    values.emplace<std::vector<double>>();
+  } else if (child_td.type_of(field) == type_t::CHAR) {
+    values.emplace<std::vector<std::string>>();
+  }
+
+  Batch batch;
+  std::vector<uint32_t> gids;
+  child->open();
+  while (child->next(batch)) {
+    if (!batch.sel.empty()) {
+      assign(batch, gids);
+      accumulate(batch, gids);
+    }
+  }
+  child->close();
+
+  order.resize(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+  // COUNT of no rows is a single 0, while the other aggregates of no rows have no value
+  empty_count = !group && keys.empty() && agg.op == AggregateOp::COUNT;
+}
+
+bool vec::Aggregate::next(Batch &batch) {
+  batch.reset(td);
+  if (empty_count) {
+    empty_count = false;
+    batch.columns[0].ints.push_back(0);
+    batch.rows = 1;
+  }
+  for (; pos < order.size() && batch.rows < BATCH_SIZE; pos++, batch.rows++) {
+    if (group) {
+      batch.columns[0].push(keys[order[pos]]);
+    }
+    batch.columns.back().push(result(order[pos]));
+  }
+  batch.selectAll();
+  return batch.rows > 0;
+}
+
+void vec::Aggregate::close() {
+  std::visit([](auto &groups) { groups.clear(); }, ids);
+  std::visit([](auto &vals) { vals.clear(); }, values);
+  keys.clear();
+  counts.clear();
+  order.clear();
+  pos = 0;
+  empty_count = false;
+}
+
+Rows::Rows(std::unique_ptr<vec::Operator> child) : child(std::move(child)) {}
+
+const TupleDesc &Rows::getTupleDesc() const { return child->getTupleDesc(); }
+
+void Rows::open() {
+  child->open();
+  batch.sel.clear();
+  pos = 0;
+}
+
+std::optional<Tuple> Rows::next() {
+  while (pos == batch.sel.size()) {
+    if (!child->next(batch)) {
+      return std::nullopt;
+    }
+    pos = 0;
+  }
+  uint16_t row = batch.sel[pos++];
+  std::vector<field_t> values;
+  values.reserve(batch.columns.size());
+  for (const auto &column : batch.columns) {
+    values.push_back(column.get(row));
+  }
+  return values;
+}
+
+void Rows::close() { child->close(); }
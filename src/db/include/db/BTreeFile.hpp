@@ -1,21 +1,257 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <db/BloomFilter.hpp>
 #include <db/DbFile.hpp>
+#include <db/KeyCodec.hpp>
+#include <db/LearnedIndex.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
 
 namespace db {
 
-class BTreeFile : public DbFile {
+class LatchGuard;
+
+/**
+ * @brief A B+ tree of tuples sorted by a key.
+ * @details The key is described by `K`: IntKey for a single INT field, whose keys are stored and searched as plain
+ * ints, or NormalizedKey for any fields, whose keys are stored as normalized bytes and compared with memcmp.
+ *  The tree is a B-link tree: every page has a link to its right sibling and a high key, the upper bound of
+ * the keys it holds. A split first moves the upper half of a page to a new right sibling and only then adds the new
+ * page to the parent, so a reader that reaches a page after it split follows the right link instead of waiting.
+ * Readers hold a shared latch on one page at a time; writers latch a page exclusively only while modifying it.
+ * insertTuple, lookup, find, lower_bound and upper_bound can be called from many threads concurrently.
+ */
+template <class K> class BasicBTreeFile : public DbFile {
+public:
+  using key_type = typename K::key_type;
+
+private:
   static constexpr size_t root_id = 0;
-  size_t key_index;
+  K codec;
+  bool unique;
+  std::mutex alloc_mutex;
+
+  /// Deletes restructure the tree and hold this exclusively; inserts and lookups hold it shared
+  mutable std::shared_mutex tree_latch;
+
+  /// The rightmost page of each level (0 for leaves), or 0 if unknown. Appends start from these pages.
+  std::array<std::atomic<size_t>, 16> rightmost{};
+
+  /// The filter of the keys, if enabled; only replaced while `tree_latch` is held exclusively
+  std::unique_ptr<BloomFilter> bloom;
+  size_t bloom_bits_per_key = 0;
+
+  /// The number of keys the filter is sized for, and the number of keys added to it
+  size_t bloom_capacity = 0;
+  std::atomic<size_t> bloom_keys{0};
+
+  /// Set when the filter holds more keys than it is sized for, so that the next insert rebuilds it
+  std::atomic<bool> bloom_full{false};
+
+  /// Set while `<name>.bloom` holds the filter and no insert has changed the file since it was written. The next
+  /// insert removes `<name>.bloom` before it changes a leaf, so a filter read back never lacks a key of the file.
+  std::atomic<bool> bloom_saved{false};
+
+  mutable BloomCounters bloom_stats;
+
+  /// The model of the positions of the keys in the leaves, if built; the file is then read-only
+  std::unique_ptr<LearnedIndex> learned;
+  std::optional<size_t> learned_error;
+
+  /// The leaves modeled by `learned`: they are consecutive pages from `learned_leaf`, and all but the last hold
+  /// `learned_fill` tuples, so position `p` is slot `p % learned_fill` of page `learned_leaf + p / learned_fill`
+  size_t learned_leaf = 0;
+  size_t learned_fill = 0;
+
+  /**
+   * @brief Build the filter from the keys of the tree, with room for as many more keys.
+   * @note `tree_latch` must be held exclusively.
+   */
+  void buildBloomFilter();
+
+  /**
+   * @brief Build the filter from the hashes of the keys of the tree, with room for as many more keys.
+   */
+  void buildBloomFilter(const std::vector<uint64_t> &hashes);
+
+  /**
+   * @brief Write the filter next to the file, or remove the written filter if there is none.
+   */
+  void saveBloomFilter() const;
+
+  /**
+   * @brief Check the filter, if any, before a lookup reads a leaf.
+   * @return false if the filter rules out the key
+   */
+  bool mayContain(const key_type &key) const;
+
+  /**
+   * @brief Count a lookup that passed the filter but did not find its key.
+   */
+  void missed() const;
+
+  /**
+   * @brief Allocate a new empty page, from the free list if possible or else at the end of the file.
+   * @return the page number of the new page
+   */
+  size_t allocatePage();
+
+  /**
+   * @brief Add a page that is no longer part of the tree to the free list.
+   * @details The free list is a chain of pages through their first bytes, starting from `free_page` in the root.
+   * @param id the page number of the page
+   */
+  void freePage(size_t id);
+
+  /**
+   * @brief Merge two adjacent leaves, or move tuples between them so that both are at least half full.
+   * @param left_id the page number of the left leaf
+   * @param right_id the page number of the right leaf
+   * @param separator the key that separates the leaves in their parent; updated if tuples are moved
+   * @return true if the leaves were merged into the left one, and the right one must be removed from the parent
+   */
+  bool rebalanceLeaves(size_t left_id, size_t right_id, key_type &separator);
+
+  /**
+   * @brief Merge two adjacent index pages, or move keys between them so that both are at least half full.
+   * @param left_id the page number of the left page
+   * @param right_id the page number of the right page
+   * @param separator the key that separates the pages in their parent; updated if keys are moved
+   * @return true if the pages were merged into the left one, and the right one must be removed from the parent
+   */
+  bool rebalanceNodes(size_t left_id, size_t right_id, key_type &separator);
+
+  /**
+   * @brief Find the page of a level that may contain a key.
+   * @details Traverse the tree from the root, choosing the child of each index page with a binary search over its keys
+   * and following the right link of pages that split concurrently.
+   * @param key the key to search for
+   * @param level the level of the page (0 for leaves)
+   * @param lower whether to find the leftmost page that may contain the key, which differs from the page where the key
+   * would be inserted only if keys are not unique
+   * @return the page number of the page, or the root for a leaf of an empty tree
+   */
+  size_t descend(const key_type &key, uint8_t level, bool lower) const;
+
+  /**
+   * @brief Find the leaf that may contain a key.
+   * @param key the key to search for
+   * @return the page number of the leaf
+   */
+  size_t findLeaf(const key_type &key) const;
+
+  /**
+   * @brief Latch the leaf that contains a key, starting from a leaf to its left.
+   * @param guard the guard that will hold the latch of the leaf
+   * @param id the page number of the leaf to start from; updated to the leaf that contains the key
+   * @param key the key to search for
+   * @param exclusive whether to latch the leaf exclusively
+   * @param lower whether to find the leftmost leaf that may contain the key
+   */
+  void latchLeaf(std::optional<LatchGuard> &guard, size_t &id, const key_type &key, bool exclusive,
+                 bool lower = false) const;
+
+  /**
+   * @brief Find the first tuple with a key that is not less than a given key, and latch its leaf.
+   * @param guard the guard that will hold the shared latch of the leaf; left empty if the tree is empty
+   * @param id set to the page number of the leaf
+   * @param key the key to search for
+   * @return the slot of the tuple, or the size of the leaf if it is in the next leaf
+   */
+  size_t seek(std::optional<LatchGuard> &guard, size_t &id, const key_type &key) const;
+
+  /**
+   * @brief Like seek, but the leaf and the first slots to search are predicted by the learned index.
+   */
+  size_t seekLearned(std::optional<LatchGuard> &guard, size_t &id, const key_type &key) const;
+
+  /**
+   * @brief Find the index pages on the path from a page to a leaf.
+   * @param id the page number of the index page to start from
+   * @param key a key of the leaf
+   * @param leaf the page number of the leaf
+   * @param path the pages on the path, from `id` to the parent of the leaf, are appended to this vector
+   * @return true if the leaf was found under `id`
+   */
+  bool findPath(size_t id, const key_type &key, size_t leaf, std::vector<size_t> &path) const;
+
+  /**
+   * @brief Insert a separator key for a new page into its parent level, splitting pages up to the root as needed.
+   * @param key the smallest key of the new page
+   * @param left the page number of the page that was split
+   * @param child the page number of the new page, which goes right after `left`
+   * @param level the level of the parent
+   * @param held the exclusive latch of `left`, released once the page that gets the separator is latched
+   */
+  void insertSeparator(key_type key, size_t left, size_t child, uint8_t level, std::optional<LatchGuard> &held);
+
+  /**
+   * @brief Latch the cached rightmost page of a level if a key belongs to it.
+   * @param guard the guard that will hold the latch of the page; left empty if the key does not belong to the page
+   * @param level the level of the page (0 for leaves)
+   * @param key the key to insert
+   * @return the page number of the page
+   */
+  size_t latchRightmost(std::optional<LatchGuard> &guard, uint8_t level, const key_type &key);
+
+  /**
+   * @brief Split the full root, which must be latched exclusively.
+   * @details The contents of the root are moved to two new pages, and the root becomes their parent so that it stays
+   * at page 0.
+   * @param root_page the root page
+   * @param fill the fraction of the keys that stay in the left page
+   */
+  void splitRoot(Page &root_page, double fill);
+
+  /**
+   * @brief Look up sorted keys in the subtree of an index page, visiting each page on the way once.
+   * @details The keys are split among the children of the page, and keys past its high key are passed to its right
+   * sibling after the children are done, so the matches are appended in key order.
+   * @param id the page number of the index page
+   * @param keys the keys to look up, sorted and without duplicates
+   * @param out the tuples with the keys are appended to this vector
+   */
+  void probeNode(size_t id, std::span<const key_type> keys, std::vector<Tuple> &out) const;
+
+  /**
+   * @brief Look up sorted keys in consecutive leaves.
+   * @details The leaves are read into the BufferPool a few at a time, in page order, before they are searched.
+   * @param leaves the leaf that may contain each run of keys, in key order
+   * @param out the tuples with the keys are appended to this vector
+   */
+  void probeLeaves(const std::vector<std::pair<size_t, std::span<const key_type>>> &leaves,
+                   std::vector<Tuple> &out) const;
+
+  /**
+   * @brief Get the iterator to a slot of a leaf, moving to the next leaf if the slot is past the last tuple.
+   */
+  Iterator position(size_t leaf, size_t slot, size_t size, size_t next_leaf) const;
+
+  /**
+   * @brief Bulk load the tree from a file that is sorted by the key.
+   */
+  void load(const DbFile &in, double fill_factor);
 
 public:
 
   /**
    * @brief Initialize a BTreeFile
    *
-   * @param key_index the index of the key in the tuple
+   * @param codec the key of the tuples (for int keys, the index of the key in the tuple)
+   * @param unique whether keys are unique; if so, inserting a tuple with an existing key replaces the old tuple, and
+   * otherwise all tuples with the same key are kept
+   */
+  BasicBTreeFile(const std::string &name, const TupleDesc &td, const K &codec, bool unique = true);
+
+  /**
+   * @brief Write the Bloom filter, if any, next to the file.
    */
-  BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index);
+  ~BasicBTreeFile() override;
 
   /**
    * @brief Insert a tuple into the file
@@ -23,10 +259,101 @@ public:
    * If the leaf node is full, split the node and insert the new key and child to the parent node. This process is repeated
    * until no more split is needed. If the root node is split, create a create two new nodes with the contents of the root
    * and set the root to be the parent of the two new nodes.
+   * Keys that are greater than or equal to the first key of the rightmost leaf are appended without a traversal, and
+   * a page that fills up with appends is split 90/10 instead of in half, so that sequential keys fill the leaves.
    * @param t the tuple to insert
+   * @throws std::logic_error if the file has a learned index
+   * @note Safe to call concurrently with other inserts and lookups.
    */
   void insertTuple(const Tuple &t) override;
 
+  /**
+   * @brief Get the tuple with the given key.
+   * @param key the key to search for
+   * @return the tuple, or nothing if there is no tuple with this key
+   * @note Unlike find, the tuple is read while the leaf is latched, so the result is consistent under concurrent inserts.
+   */
+  std::optional<Tuple> lookup(const key_type &key) const;
+
+  /**
+   * @brief Get the tuples with any of the given keys.
+   * @details The keys are sorted and the tree is descended once for all of them: every index page on the paths to their
+   * leaves is latched and searched once, and every leaf is read once even if it holds many of the keys.
+   * @param keys the keys to search for, in any order; duplicates are looked up once
+   * @return the tuples with the keys, in key order (all of the tuples with a key if keys are not unique)
+   * @note Safe to call concurrently with inserts and lookups.
+   */
+  std::vector<Tuple> multiGet(std::span<const key_type> keys) const;
+
+  /**
+   * @brief Build the tree bottom-up from the tuples of another file
+   * @details The tuples are read in key order; if `in` is not sorted by the key, it is first sorted with an external
+   * sort. Leaves are packed left-to-right up to the fill factor and written sequentially, directly to the file and
+   * without going through the BufferPool. The index levels are then built from the first key of every node of the
+   * level below, and the root is written last. If several tuples have the same key, the last one is kept when keys are
+   * unique, and all of them are kept otherwise.
+   * @param in the file to read the tuples from (with the same schema as this file)
+   * @param fill_factor the fraction of each page to fill, in (0, 1]
+   * @throws std::logic_error if the tree is not empty or the fill factor is out of range
+   */
+  void bulkLoad(const DbFile &in, double fill_factor = 1.0);
+
+  /**
+   * @brief Keep a Bloom filter of the keys, so that lookups of missing keys usually do not read a leaf
+   * @details The filter is built from the keys of the tree, and then every insert adds its key to it; bulkLoad builds
+   * it from the loaded keys. A filter that holds twice the keys it was built for is rebuilt larger by the next insert.
+   * Deleted keys stay in the filter until it is rebuilt. The filter is written to `<name>.bloom` when the file is
+   * destroyed, and read back when a non-empty file is opened. The first insert after that removes `<name>.bloom`, so
+   * if the file is not destroyed cleanly, it is next opened without a filter instead of one that misses keys.
+   * lookup, find and multiGet check the filter before they read a leaf.
+   * @param bits_per_key the number of bits per key; 10 bits give about 1% false positives
+   */
+  void enableBloomFilter(size_t bits_per_key = DEFAULT_BLOOM_BITS_PER_KEY);
+
+  /**
+   * @brief Get the counters of the Bloom filter
+   * @return the counters, or nothing if there is no filter
+   */
+  std::optional<BloomStats> getBloomStats() const;
+
+  /**
+   * @brief Replace the index pages with a learned index for lookups in a read-only file
+   * @details The learned index is a piecewise-linear model that maps a key to its position in the leaves written by
+   * bulkLoad, within `max_error` positions, so lookup, find and lower_bound read the predicted leaf without reading any
+   * index page and only search the predicted slots. If the file is empty, the model is built by the next bulkLoad;
+   * otherwise it is built from the leaves, which must not have changed since bulkLoad. The model is kept in memory
+   * only. The file becomes read-only once the model is built.
+   * @param max_error the largest distance between the predicted and the actual position of a key
+   * @throws std::logic_error if the key is not a single int, or the leaves were not written by bulkLoad
+   */
+  void enableLearnedIndex(size_t max_error = DEFAULT_LEARNED_ERROR);
+
+  /**
+   * @brief Get the learned index
+   * @return the model, or nullptr if it was not built
+   */
+  const LearnedIndex *getLearnedIndex() const;
+
+  /**
+   * @brief Get the index of the key in the tuple (the first key field if the key has several fields)
+   */
+  size_t getKeyIndex() const;
+
+  /**
+   * @brief Get the key of the tuples, which also encodes key values for lookups
+   */
+  const K &getKeyCodec() const;
+
+  /**
+   * @brief Delete a tuple from the file
+   * @details Remove the tuple from its leaf. A leaf that becomes less than half full is merged with a sibling, or takes
+   * tuples from it if they do not fit in one page, and the parent is updated. The same is repeated for index pages up to
+   * the root, and a root that is left with a single index child is replaced by that child. Pages removed from the tree
+   * are added to a free list that later splits allocate from.
+   * @param it the iterator to the tuple; all iterators of the file are invalidated
+   * @throws std::logic_error if the file has a learned index
+   * @note Deletes are not concurrent: a delete waits for running inserts and lookups, and blocks new ones.
+   */
   void deleteTuple(const Iterator &it) override;
 
   /**
@@ -58,5 +385,47 @@ public:
    * @return The iterator to the end of the file.
    */
   Iterator end() const override;
+
+  /**
+   * @brief Find the tuple with the given key.
+   * @details Traverse the tree to the leaf that may contain the key and binary search the leaf.
+   * @param key the key to search for
+   * @return the iterator to the tuple, or end() if there is no tuple with this key
+   */
+  Iterator find(const key_type &key) const;
+
+  /**
+   * @brief Get the iterator to the first tuple whose key is not less than the given key.
+   * @param key the key to search for
+   * @return the iterator to the tuple, or end() if every key is less than `key`
+   */
+  Iterator lower_bound(const key_type &key) const;
+
+  /**
+   * @brief Get the iterator to the first tuple whose key is greater than the given key.
+   * @param key the key to search for
+   * @return the iterator to the tuple, or end() if no key is greater than `key`
+   */
+  Iterator upper_bound(const key_type &key) const;
+
+  /**
+   * @brief Get the tuples with keys in the range [lo, hi).
+   * @param lo the smallest key of the range
+   * @param hi the key following the largest key of the range
+   * @return the morsel that contains the tuples of the range
+   */
+  Morsel range(const key_type &lo, const key_type &hi) const;
+
+  /**
+   * @brief Split the file into morsels of consecutive leaves.
+   * @details Descend the tree level by level until a level has at least `n` subtrees (or the leaves are reached).
+   * The subtrees of that level are grouped into `n` contiguous ranges using the separators of the index pages. A morsel
+   * starts at the leftmost leaf of its range and ends at the leftmost leaf of the following range.
+   * @param n The requested number of morsels.
+   * @return The morsels of the file.
+   */
+  std::vector<Morsel> partition(size_t n) const override;
 };
+
+using BTreeFile = BasicBTreeFile<IntKey>;
 } // namespace db
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <db/BTreeFile.hpp>
+
+namespace db {
+
+/**
+ * @brief A secondary index over an int field of a HeapFile.
+ * @details The index is a BTreeFile whose tuples are (key, page, slot) entries, one for every tuple of the HeapFile,
+ * where (page, slot) is the record id of the tuple. The entries are ordered by key and then by record id, so an entry
+ * is found with a single descent however many tuples share its key. A HeapFile keeps the indexes that were added to it
+ * up to date when tuples are inserted or deleted.
+ * An index can include other fields of the HeapFile in its entries, after the record id. A query that only reads the
+ * key and the included fields is answered from the leaves of the index (an index-only scan), without reading the
+ * HeapFile.
+ */
+class BTreeIndex : public BasicBTreeFile<NormalizedKey> {
+  size_t field;
+  std::vector<size_t> include;
+
+public:
+  /**
+   * @brief Initialize a BTreeIndex
+   * @param name the name of the index file
+   * @param field the index of the indexed field in the tuples of the HeapFile
+   */
+  BTreeIndex(const std::string &name, size_t field);
+
+  /**
+   * @brief Initialize a BTreeIndex that includes other fields of the HeapFile
+   * @details The included fields keep their names and types in the entries, which must not clash with "key", "page" and
+   * "slot".
+   * @param name the name of the index file
+   * @param td the tuple descriptor of the HeapFile
+   * @param field the index of the indexed field in the tuples of the HeapFile
+   * @param include the indexes of the included fields in the tuples of the HeapFile
+   */
+  BTreeIndex(const std::string &name, const TupleDesc &td, size_t field, const std::vector<size_t> &include);
+
+  /**
+   * @brief Get the index of the indexed field in the tuples of the HeapFile
+   */
+  size_t getField() const;
+
+  /**
+   * @brief Check whether the entries hold fields of the HeapFile
+   * @param fields the indexes of the fields in the tuples of the HeapFile
+   * @return true if every field is the indexed field or an included field
+   */
+  bool covers(const std::vector<size_t> &fields) const;
+
+  /**
+   * @brief Get the position of a field of the HeapFile in the entries
+   * @param field the index of the field in the tuples of the HeapFile
+   * @return the index of the field in the entries
+   * @throws std::logic_error if the field is not covered by the index
+   */
+  size_t entryField(size_t field) const;
+
+  /**
+   * @brief Add the record id of a tuple
+   * @param t the tuple of the HeapFile
+   * @param page the page of the tuple in the HeapFile
+   * @param slot the slot of the tuple in its page
+   */
+  void insertEntry(const Tuple &t, size_t page, size_t slot);
+
+  /**
+   * @brief Remove the record id of a tuple
+   * @param key the value of the indexed field of the tuple
+   * @param page the page of the tuple in the HeapFile
+   * @param slot the slot of the tuple in its page
+   * @throws std::logic_error if there is no such entry
+   */
+  void deleteEntry(int key, size_t page, size_t slot);
+
+  /**
+   * @brief Get the entries with keys in a range
+   * @param lo the smallest key (inclusive)
+   * @param hi the largest key (inclusive)
+   * @return the morsel that contains the entries, in key and record id order
+   */
+  Morsel entries(int lo, int hi) const;
+
+  /**
+   * @brief Get the record ids of the tuples with keys in a range
+   * @details The record ids are sorted by page and slot, so that fetching the tuples reads every page of the HeapFile at
+   * most once and in file order.
+   * @param heap the indexed HeapFile
+   * @param lo the smallest key (inclusive)
+   * @param hi the largest key (inclusive)
+   * @return iterators of `heap` that point to the tuples
+   */
+  std::vector<Iterator> rids(const DbFile &heap, int lo, int hi) const;
+};
+} // namespace db
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace db {
+
+/// The default number of filter bits per key, for a false positive rate of about 1%
+constexpr size_t DEFAULT_BLOOM_BITS_PER_KEY = 10;
+
+/**
+ * @brief The counters of the probes of a BloomFilter.
+ */
+struct BloomStats {
+  /// The number of probes
+  size_t probes;
+
+  /// The number of probes that ruled out the key
+  size_t negatives;
+
+  /// The number of probes that passed for a key that was then not found
+  size_t false_positives;
+};
+
+/**
+ * @brief Counts the probes of the Bloom filters of a file.
+ */
+class BloomCounters {
+  std::atomic<size_t> probes{0};
+  std::atomic<size_t> negatives{0};
+  std::atomic<size_t> false_positives{0};
+
+public:
+  /**
+   * @brief Count a probe
+   * @param may_contain the result of the probe
+   * @return the result of the probe
+   */
+  bool count(bool may_contain);
+
+  /**
+   * @brief Count a probe that passed for a key that was then not found
+   */
+  void addFalsePositive();
+
+  BloomStats get() const;
+};
+
+/**
+ * @brief A blocked Bloom filter of key hashes.
+ * @details The filter is an array of 64-byte blocks, each a cache line of eight 64-bit words. The upper half of the
+ * hash of a key chooses a block, and the lower half sets one bit in every word of the block, chosen by multiplying it
+ * with eight odd constants. A probe reads a single cache line, and is checked with AVX2 when the CPU supports it.
+ * Keys can be inserted concurrently with other inserts and probes.
+ */
+class BloomFilter {
+  struct alignas(64) Block {
+    uint64_t words[8];
+  };
+
+  std::vector<Block> blocks;
+
+public:
+  /**
+   * @brief Create an empty filter
+   * @param keys the number of keys the filter is sized for
+   * @param bits_per_key the number of bits per key; more bits mean fewer false positives
+   */
+  BloomFilter(size_t keys, size_t bits_per_key);
+
+  /**
+   * @brief Get the size of the blocks of a filter
+   * @param keys the number of keys the filter is sized for
+   * @param bits_per_key the number of bits per key
+   * @return the size in bytes, a multiple of 64
+   */
+  static size_t sizeFor(size_t keys, size_t bits_per_key);
+
+  /**
+   * @brief Load a filter that was written with `data()`
+   * @param data the blocks of the filter
+   * @param size the size of the blocks in bytes, a multiple of 64
+   */
+  BloomFilter(const uint8_t *data, size_t size);
+
+  static uint64_t hash(int key);
+
+  static uint64_t hash(const std::string &key);
+
+  /**
+   * @brief Add a key to the filter
+   * @param hash the hash of the key
+   */
+  void insert(uint64_t hash);
+
+  /**
+   * @brief Check whether a key may have been added to the filter
+   * @param hash the hash of the key
+   * @return false if the key was never added
+   */
+  bool mayContain(uint64_t hash) const;
+
+  /**
+   * @brief Get the blocks of the filter, to persist them
+   */
+  const uint8_t *data() const;
+
+  /**
+   * @brief Get the size of the blocks in bytes
+   */
+  size_t size() const;
+};
+} // namespace db
@@ -2,6 +2,8 @@
 
 #include <db/types.hpp>
 #include <list>
+#include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -14,6 +16,8 @@ constexpr size_t DEFAULT_NUM_PAGES = 50;
  * It provides functions to get a page, mark a page as dirty, and check the status of pages.
  * The class also supports flushing pages to disk and discarding pages from the buffer pool.
  * @note A BufferPool owns the Page objects that are stored in it.
+ * @note All methods are thread-safe. A page returned by getPage may be evicted by a concurrent caller; threads that
+ * share the pool should use pinPage/unpinPage (or a PageGuard) to keep a page resident while they access it.
  */
 class BufferPool {
   std::array<Page, DEFAULT_NUM_PAGES> pages;
@@ -23,6 +27,9 @@ class BufferPool {
   std::vector<size_t> available;
   std::list<size_t> lru_list;
   std::unordered_map<size_t, std::list<size_t>::iterator> pos_to_lru;
+  std::array<size_t, DEFAULT_NUM_PAGES> pins{};
+  std::array<std::shared_mutex, DEFAULT_NUM_PAGES> latches;
+  mutable std::recursive_mutex mutex;
 
 public:
   /**
@@ -51,6 +58,28 @@ public:
    */
   Page &getPage(const PageId &pid);
 
+  /**
+   * @brief: Returns the page with the specified page id and pins it in the buffer pool.
+   * @param pid: The page id of the page to return.
+   * @return: The page with the specified page id.
+   * @note A pinned page is never chosen for eviction. Every call must be matched by a call to unpinPage.
+   * @throws std::runtime_error if the page is not resident and every page of the pool is pinned.
+   */
+  Page &pinPage(const PageId &pid);
+
+  /**
+   * @brief: Releases one pin of the page with the specified page id.
+   * @param pid: The page id of the page to unpin.
+   */
+  void unpinPage(const PageId &pid);
+
+  /**
+   * @brief: Returns the latch that protects the contents of the page with the specified page id.
+   * @param pid: The page id of the page. The page must be pinned.
+   * @return: The latch of the page.
+   */
+  std::shared_mutex &getLatch(const PageId &pid);
+
   /**
    * @brief: Marks the page with the specified page id as dirty.
    * @param pid: The page id of the page to mark as dirty.
@@ -91,5 +120,56 @@ public:
    * @note This method should call BufferPool::flushPage(pid).
    */
   void flushFile(const std::string &file);
+
+  /**
+   * @brief: Discards all pages of the specified file from the buffer pool.
+   * @param file: The name of the associated file.
+   * @note This method does NOT flush the pages to disk.
+   */
+  void discardFile(const std::string &file);
+};
+
+/**
+ * @brief Keeps a page pinned in a BufferPool for the lifetime of the guard.
+ */
+class PageGuard {
+  BufferPool &bufferPool;
+  const PageId pid;
+
+public:
+  Page &page;
+
+  PageGuard(BufferPool &bufferPool, const PageId &pid)
+      : bufferPool(bufferPool), pid(pid), page(bufferPool.pinPage(pid)) {}
+
+  ~PageGuard() { bufferPool.unpinPage(pid); }
+
+  PageGuard(const PageGuard &) = delete;
+
+  PageGuard &operator=(const PageGuard &) = delete;
+};
+
+/**
+ * @brief Keeps a page pinned in a BufferPool and holds its latch, in shared or exclusive mode, for the lifetime of the
+ * guard.
+ */
+class LatchGuard {
+  PageGuard guard;
+  std::shared_mutex &latch;
+  const bool exclusive;
+
+public:
+  Page &page;
+
+  LatchGuard(BufferPool &bufferPool, const PageId &pid, bool exclusive)
+      : guard(bufferPool, pid), latch(bufferPool.getLatch(pid)), exclusive(exclusive), page(guard.page) {
+    exclusive ? latch.lock() : latch.lock_shared();
+  }
+
+  ~LatchGuard() { exclusive ? latch.unlock() : latch.unlock_shared(); }
+
+  LatchGuard(const LatchGuard &) = delete;
+
+  LatchGuard &operator=(const LatchGuard &) = delete;
 };
 } // namespace db
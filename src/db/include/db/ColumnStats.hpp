@@ -1,6 +1,7 @@
 #pragma once
 
 #include <db/Query.hpp>
+#include <vector>
 
 namespace db {
 
@@ -8,7 +9,15 @@ namespace db {
  * A class to represent a fixed-width histogram over a single integer-based field.
  */
 class ColumnStats {
-  // TODO pa4: add private members
+  std::vector<size_t> histogram;
+  int min;
+  int max;
+
+  /// The number of values of each bucket; the last bucket may extend past max
+  int width;
+
+  /// The number of values added
+  size_t count = 0;
 
 public:
   /**
@@ -6,6 +6,20 @@
 
 namespace db {
 
+/**
+ * @brief A contiguous range of tuples of a file that can be scanned independently of the other ranges.
+ * @details Advancing `first` with `DbFile::next` eventually reaches `last`. A morsel can be used in a range-based for
+ * loop just like a DbFile.
+ */
+struct Morsel {
+  Iterator first;
+  Iterator last;
+
+  Iterator begin() const { return first; }
+
+  Iterator end() const { return last; }
+};
+
 /**
  * @brief Represents a database file.
  * @details It provides functions to read and write pages to the file, as well as to insert and delete tuples.
@@ -72,6 +86,15 @@ public:
 
   virtual Iterator end() const;
 
+  /**
+   * @brief Split the file into morsels that can be scanned concurrently.
+   * @details The morsels are disjoint, ordered, and together cover every tuple of the file.
+   * @param n The requested number of morsels. Fewer morsels may be returned if the file is too small.
+   * @return The morsels of the file.
+   * @note The default implementation returns a single morsel spanning the whole file.
+   */
+  virtual std::vector<Morsel> partition(size_t n) const;
+
   size_t getNumPages() const;
 
   const TupleDesc &getTupleDesc() const;
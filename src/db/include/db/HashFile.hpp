@@ -0,0 +1,143 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+
+namespace db {
+
+/// The number of page numbers that fit in a directory page
+constexpr size_t DIRECTORY_PAGE_ENTRIES = DEFAULT_PAGE_SIZE / sizeof(size_t);
+
+struct HashFileHeader {
+  /// The first page of the list of free pages, or 0
+  size_t free_page;
+
+  /// The number of low hash bits that index the directory
+  uint8_t global_depth;
+
+  /// The number of directory pages
+  uint16_t num_directory_pages;
+
+  /// The directory pages; together they map each value of the low `global_depth` bits of a hash to a bucket page
+  size_t directory[(DEFAULT_PAGE_SIZE - 2 * sizeof(size_t)) / sizeof(size_t)];
+};
+
+static_assert(sizeof(HashFileHeader) <= DEFAULT_PAGE_SIZE);
+
+/**
+ * @brief A file of tuples hashed by a key, for equality lookups that read one page.
+ * @details The file uses extendible hashing. The first page holds the header and the list of directory pages. The
+ * directory maps the low `global_depth` bits of the hash of a key to the first page of a bucket. A bucket that fills up
+ * is split in two by one more bit of the hash, doubling the directory if needed; a bucket whose keys all have the same
+ * hash, or that cannot split because the directory is at its largest, grows a chain of overflow pages instead.
+ * Buckets are not merged when tuples are deleted, but empty overflow pages are unlinked and reused.
+ * The tuples are scanned in page order, not in key order.
+ */
+class HashFile : public DbFile {
+  size_t key_index;
+  bool unique;
+
+  /**
+   * @brief Create the directory and the first bucket of an empty file.
+   */
+  void init();
+
+  /**
+   * @brief Allocate a new empty page, from the free list if possible or else at the end of the file.
+   * @return the page number of the new page
+   */
+  size_t allocatePage();
+
+  /**
+   * @brief Add a page that is no longer used to the free list.
+   * @param id the page number of the page
+   */
+  void freePage(size_t id);
+
+  /**
+   * @brief Get the first page of the bucket of a hash.
+   * @param hash the hash of a key
+   * @return the page number of the bucket, or 0 if the file is empty
+   */
+  size_t bucket(uint32_t hash) const;
+
+  /**
+   * @brief Double the directory, so that it is indexed by one more bit of the hash.
+   */
+  void grow();
+
+  /**
+   * @brief Split a full bucket by one more bit of the hash of its keys.
+   * @param id the first page of the bucket
+   */
+  void split(size_t id);
+
+  /**
+   * @brief Get the iterator to the first tuple stored in a bucket page at or after a page.
+   * @param page The page to start searching from.
+   * @return The iterator to the first tuple found, or end() if there is none.
+   */
+  Iterator seek(size_t page) const;
+
+public:
+  /// The largest global depth; the directory pages of this depth fill the header
+  static constexpr uint8_t MAX_GLOBAL_DEPTH = 17;
+
+  /**
+   * @brief Initialize a HashFile
+   * @param key_index the index of the key in the tuple
+   * @param unique whether keys are unique; if so, inserting a tuple with an existing key replaces the old tuple, and
+   * otherwise all tuples with the same key are kept
+   */
+  HashFile(const std::string &name, const TupleDesc &td, size_t key_index, bool unique = true);
+
+  /**
+   * @brief Insert a tuple into the file
+   * @details The tuple is added to the first page of its bucket that has room. If the bucket is full, it is split and
+   * the insert is retried, or an overflow page is added to the bucket if splitting would not separate its keys.
+   * @param t the tuple to insert
+   * @throws std::runtime_error if the tuple is not compatible with the TupleDesc
+   */
+  void insertTuple(const Tuple &t) override;
+
+  /**
+   * @brief Delete a tuple from the file
+   * @details The last tuple of the page is moved to the slot of the deleted tuple, and an overflow page that becomes
+   * empty is removed from its bucket.
+   * @param it the iterator to the tuple; all iterators of the file are invalidated
+   */
+  void deleteTuple(const Iterator &it) override;
+
+  Tuple getTuple(const Iterator &it) const override;
+
+  void next(Iterator &it) const override;
+
+  Iterator begin() const override;
+
+  Iterator end() const override;
+
+  /**
+   * @brief Find a tuple with the given key.
+   * @details Only the pages of the bucket of the key are read, and only tuples whose hash matches are deserialized.
+   * @param key the key to search for
+   * @return the iterator to the tuple, or end() if there is no tuple with this key
+   */
+  Iterator find(const field_t &key) const;
+
+  /**
+   * @brief Get every tuple with the given key.
+   * @param key the key to search for
+   * @return the tuples, in no particular order
+   */
+  std::vector<Tuple> findAll(const field_t &key) const;
+
+  /**
+   * @brief Get the index of the key in the tuple
+   */
+  size_t getKeyIndex() const;
+
+  /**
+   * @brief Get the number of low hash bits that index the directory
+   */
+  uint8_t getGlobalDepth() const;
+};
+} // namespace db
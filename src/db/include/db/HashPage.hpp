@@ -0,0 +1,82 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+
+namespace db {
+
+struct HashPageHeader {
+  /// The next page of the overflow chain of the bucket, or 0
+  size_t overflow;
+
+  /// The number of tuples in the page
+  uint16_t size;
+
+  /// The number of low hash bits shared by every key of the bucket; only kept in the first page of a bucket
+  uint8_t depth;
+};
+
+struct HashPage {
+  const TupleDesc &td;
+
+  uint16_t capacity;
+
+  HashPageHeader *header;
+
+  /// The hash of the key of each tuple, so that lookups and splits do not deserialize the tuples
+  uint32_t *hashes;
+
+  /// The tuples, in insertion order. The first `size` positions are occupied.
+  uint8_t *data;
+
+  /**
+   * @brief Initialize a bucket page of a HashFile
+   * @details The provided page has a header of type HashPageHeader, followed by an array of `capacity` hashes and the
+   * tuples. The capacity of the page is calculated based on the remaining size of the page and the size of the tuples.
+   * @param page the page contents
+   * @param td the tuple descriptor
+   */
+  HashPage(Page &page, const TupleDesc &td);
+
+  bool full() const { return header->size == capacity; }
+
+  /**
+   * @brief Append a tuple to the page
+   * @param t the tuple to insert
+   * @param hash the hash of the key of the tuple
+   * @throws std::logic_error if the page is full
+   */
+  void insertTuple(const Tuple &t, uint32_t hash);
+
+  /**
+   * @brief Append a serialized tuple to the page
+   * @param tuple the serialized tuple, `td.length()` bytes
+   * @param hash the hash of the key of the tuple
+   * @throws std::logic_error if the page is full
+   */
+  void insertTuple(const uint8_t *tuple, uint32_t hash);
+
+  /**
+   * @brief Replace a tuple of the page with a tuple with the same key
+   * @param slot the slot of the tuple to replace
+   * @param t the new tuple
+   */
+  void setTuple(size_t slot, const Tuple &t);
+
+  /**
+   * @brief Delete a tuple from the page
+   * @details The last tuple of the page is moved to the freed slot.
+   * @param slot the slot of the tuple to delete
+   * @throws std::out_of_range if the slot is not occupied
+   */
+  void deleteTuple(size_t slot);
+
+  /**
+   * @brief Get a tuple from the page.
+   * @param slot The slot of the tuple.
+   * @return The tuple read from the page.
+   * @throws std::out_of_range if the slot is not occupied
+   */
+  Tuple getTuple(size_t slot) const;
+};
+
+} // namespace db
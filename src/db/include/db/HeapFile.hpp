@@ -3,20 +3,33 @@
 #include <db/DbFile.hpp>
 
 namespace db {
+class BTreeIndex;
+
 class HeapFile : public DbFile {
+  std::vector<BTreeIndex *> indexes;
+
+  /**
+   * @brief Get the iterator to the first tuple stored in the specified page or any page after it.
+   * @param page The page to start searching from.
+   * @return The iterator to the first tuple found, or end() if there is none.
+   */
+  Iterator seek(size_t page) const;
+
 public:
   HeapFile(const std::string &name, const TupleDesc &td);
 
   /**
    * @brief Insert a tuple to the database file.
    * @details Insert a tuple to the first available slot of the last page. If the last page is full, create a new page.
+   * The record id of the tuple is added to every index of the file.
    * @param t The tuple to be inserted.
    */
   void insertTuple(const Tuple &t) override;
 
   /**
    * @brief Delete a tuple from the database file.
-   * @details Delete a tuple from the database file by marking the slot unused.
+   * @details Delete a tuple from the database file by marking the slot unused. The record id of the tuple is removed
+   * from every index of the file.
    * @param it The iterator that identifies the tuple to be deleted.
    */
   void deleteTuple(const Iterator &it) override;
@@ -51,5 +64,37 @@ public:
    * @return The iterator to the end of the file.
    */
   Iterator end() const override;
+
+  /**
+   * @brief Split the file into morsels of consecutive pages.
+   * @details The pages are divided into `n` ranges of (almost) equal length. A morsel starts at the first tuple of its
+   * page range and ends at the first tuple of the following range.
+   * @param n The requested number of morsels. At most one morsel per page is returned.
+   * @return The morsels of the file.
+   */
+  std::vector<Morsel> partition(size_t n) const override;
+
+  /**
+   * @brief Add a secondary index to the file.
+   * @details The index is filled with the record ids of the tuples of the file, and is then updated by every insert
+   * and delete. The index must stay in the Database as long as this file is used.
+   * @param index an empty index over an int field of this file
+   * @throws std::logic_error if the indexed field is not an int, or an included field has another type in the index
+   */
+  void addIndex(BTreeIndex &index);
+
+  /**
+   * @brief Get the secondary index over a field.
+   * @param field the index of the field
+   * @return the index, or nullptr if the field is not indexed
+   */
+  const BTreeIndex *getIndex(size_t field) const;
+
+  /**
+   * @brief Get a secondary index whose entries hold a set of fields, so that it can replace a scan of the file.
+   * @param fields the indexes of the fields
+   * @return the index, or nullptr if no index covers the fields
+   */
+  const BTreeIndex *getCoveringIndex(const std::vector<size_t> &fields) const;
 };
 } // namespace db
@@ -36,9 +36,10 @@ public:
    * @brief Insert a tuple to the page.
    * @details Insert a tuple to the page by serializing the tuple to the page.
    * @param t The tuple to be inserted.
+   * @param slot If not null, set to the slot of the inserted tuple.
    * @return True if the tuple is inserted successfully, false otherwise if the page is full.
    */
-  bool insertTuple(const Tuple &t);
+  bool insertTuple(const Tuple &t, size_t *slot = nullptr);
 
   /**
    * @brief Delete a tuple from the page.
@@ -63,6 +64,21 @@ public:
    */
   Tuple getTuple(size_t slot) const;
 
+  /**
+   * @brief Get the serialized tuple at the specified slot.
+   * @details The fields can be read at the offsets of the tuple descriptor without deserializing the whole tuple.
+   * @param slot The slot of the tuple.
+   * @return The bytes of the tuple, as written by TupleDesc::serialize.
+   */
+  const uint8_t *getBytes(size_t slot) const;
+
+  /**
+   * @brief Get the occupied slots of the page.
+   * @param bits set to the bitmap of the occupied slots, with slot `i` at bit `i % 64` of word `i / 64`; it must hold
+   * `pagefilter::words(end())` words.
+   */
+  void occupied(uint64_t *bits) const;
+
   /**
    * @brief Advance the slot to the next occupied slot.
    * @details Advance the slot to the next occupied slot by scanning the header.
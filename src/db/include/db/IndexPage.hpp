@@ -1,6 +1,6 @@
 #pragma once
 
-#include <db/Tuple.hpp>
+#include <db/KeyCodec.hpp>
 
 namespace db {
 
@@ -10,26 +10,45 @@ struct IndexPageHeader {
 
   /// Whether the next level is internal or leaf
   bool index_children;
+
+  /// The height of the page above the leaves (the children of a level 1 page are leaves)
+  uint8_t level;
+
+  /// The page number of the right sibling, or 0 if this is the rightmost page of its level
+  size_t right;
+
+  /// The first page of the list of free pages of the file, or 0 if there are none. Only used in the root.
+  size_t free_page;
 };
 
-struct IndexPage {
+template <class K> struct BasicIndexPage {
+  using key_type = typename K::key_type;
+  using slot_type = typename K::slot_type;
+
+  K codec;
+
   uint16_t capacity;
 
   IndexPageHeader *header;
-  int *keys;
+
+  /// The upper bound (exclusive) of the keys of the subtree, only valid if the page has a right sibling
+  slot_type *high_key;
+
+  slot_type *keys;
   size_t *children;
 
   /**
-   * @brief Initialize a leaf page
+   * @brief Initialize an index page
    *
-   * @details The provided page has a header of type IndexPageHeader, followed by `IndexPageHeader::size` keys and
-   * `IndexPageHeader::size + 1` page numbers. The keys are sorted in ascending order.
+   * @details The provided page has a header of type IndexPageHeader, followed by the high key, `IndexPageHeader::size`
+   * keys and `IndexPageHeader::size + 1` page numbers. The keys are sorted in ascending order, and each of them takes
+   * `codec.stride()` elements of the key array.
    * The capacity of the page is calculated based on the remaining size of the page.
    *
    * @param page the page contents
-   * @param key_index the index of the key in the tuple
+   * @param codec the key type of the tree
    */
-  explicit IndexPage(Page &page);
+  explicit BasicIndexPage(Page &page, const K &codec = K());
 
   /**
    * @brief Insert a new key with a corresponding child page number
@@ -37,15 +56,83 @@ struct IndexPage {
    * @param child the child page number
    * @return true if the page is full and needs to be split
    */
-  bool insert(int key, size_t child);
+  bool insert(const key_type &key, size_t child);
+
+  /**
+   * @brief Insert a new key with a corresponding child page number at a given position
+   * @details Needed when keys are not unique, where the position of a key does not determine the position of its child.
+   * @param slot the position of the key; the child is inserted at position `slot + 1`
+   * @param key the key to insert
+   * @param child the child page number
+   * @return true if the page is full and needs to be split
+   */
+  bool insertAt(size_t slot, const key_type &key, size_t child);
+
+  /**
+   * @brief Remove a key and the child to its right
+   * @param slot the position of the key
+   */
+  void erase(size_t slot);
+
+  /**
+   * @brief Get a key of the page
+   * @param slot the position of the key
+   */
+  key_type getKey(size_t slot) const;
+
+  /**
+   * @brief Replace a key of the page
+   * @param slot the position of the key
+   * @param key the new key
+   */
+  void setKey(size_t slot, const key_type &key);
+
+  key_type getHighKey() const;
+
+  void setHighKey(const key_type &key);
+
+  /**
+   * @brief Find the first key that is not less than the given key.
+   * @return the position of the key, or `header->size` if every key is less than `key`
+   */
+  size_t lower_bound(const key_type &key) const;
+
+  /**
+   * @brief Find the first key that is greater than the given key.
+   * @return the position of the key, or `header->size` if no key is greater than `key`
+   */
+  size_t upper_bound(const key_type &key) const;
+
+  /**
+   * @brief Find the child whose subtree may contain a key
+   * @details The child at position `i + 1` holds the keys that are greater than or equal to `keys[i]`.
+   * @param key the key to search for
+   * @return the page number of the child
+   */
+  size_t findChild(const key_type &key) const;
+
+  /**
+   * @brief Check whether a key belongs to a right sibling of this page
+   * @details A concurrent split may move the upper half of the keys to a new right sibling before the parent is updated.
+   * @param key the key to check
+   * @param lower whether the key is searched in the leftmost page that may contain it, which can hold keys equal to the
+   * high key if keys are not unique
+   * @return true if the page has a right sibling and the key is not less than (if `lower`, greater than) the high key
+   */
+  bool pastHighKey(const key_type &key, bool lower = false) const;
 
   /**
    * @brief Split the index page
    * @details The page is split into two pages. The old page contains the first half of the tuples, and the new page contains the second half.
+   * The new page inherits the level, the right sibling and the high key of the old page, and the split key becomes the
+   * high key of the old page. The caller links the old page to the new one.
    * @param new_page a new empty page
+   * @param fill the fraction of the keys that stay in the old page
    * @return the split key (this key is moved to the parent page)
    */
-  int split(IndexPage &new_page);
+  key_type split(BasicIndexPage &new_page, double fill = 0.5);
 };
 
+using IndexPage = BasicIndexPage<IntKey>;
+
 } // namespace db
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <db/BTreeFile.hpp>
+#include <db/BufferPool.hpp>
+#include <db/Operator.hpp>
+#include <db/TempFile.hpp>
+#include <db/Vector.hpp>
+#include <thread>
+
+/**
+ * @brief Join algorithms for the inputs that the in-memory hash table or the nested loop of op::Join do not suit.
+ * @details Every algorithm derives from op::Join and produces the same tuples, possibly in another order.
+ */
+namespace db::op {
+
+/// The default memory budget of a join, in bytes of serialized tuples: half of the buffer pool
+constexpr size_t DEFAULT_JOIN_MEMORY = DEFAULT_NUM_PAGES / 2 * DEFAULT_PAGE_SIZE;
+
+/**
+ * @brief An equi-join that spills to temporary partitions when the right child does not fit in memory (Grace hash
+ * join).
+ * @details The right child is read into an in-memory hash table while its tuples fit in the memory budget, and the
+ * left child is then streamed through the table. Once the budget is exceeded, the tuples of the table and the rest of
+ * the right child are instead hashed on the join field into HASH_JOIN_FAN_OUT temporary HeapFiles, and the left child
+ * is hashed into as many files. Matching tuples land in partitions with the same number, so the partitions are joined
+ * pair by pair with an in-memory hash table. A right partition that still exceeds the budget is partitioned again, with
+ * another hash, up to HASH_JOIN_MAX_DEPTH levels; past that level (e.g. when most tuples share a join value) it is
+ * joined in memory anyway. Partition pairs with an empty side are skipped.
+ * @throws std::logic_error if the join predicate is not an equality.
+ */
+class HashJoin : public Join {
+public:
+  /// The number of partitions of each level: each partition keeps the page it inserts into in the buffer pool
+  static constexpr size_t HASH_JOIN_FAN_OUT = DEFAULT_NUM_PAGES / 4;
+  static constexpr size_t HASH_JOIN_MAX_DEPTH = 3;
+
+  struct Stats {
+    /// The number of partitions written, over every level
+    size_t partitions = 0;
+
+    /// The number of levels of partitions
+    size_t depth = 0;
+
+    /// The tuples and bytes written to the partitions, of both children
+    size_t spilled_tuples = 0;
+    size_t spilled_bytes = 0;
+  };
+
+private:
+  struct Partition {
+    std::unique_ptr<TempFile> left;
+    std::unique_ptr<TempFile> right;
+    size_t right_tuples = 0;
+    size_t depth = 0;
+  };
+
+  size_t memory;
+  Stats stats;
+
+  /// The partitions that are not joined yet, and the one being joined
+  std::vector<Partition> pending;
+  Partition joined;
+
+  /// The tuples streamed through the table: the left child, or a scan of the left partition being joined
+  Operator *probe = nullptr;
+  std::unique_ptr<Operator> partition_scan;
+
+  /**
+   * @brief The partitions of one child at one level.
+   */
+  struct Spill {
+    std::vector<std::unique_ptr<TempFile>> files;
+    std::vector<size_t> counts;
+  };
+
+  size_t partitionOf(const field_t &key, size_t depth) const;
+
+  /**
+   * @brief Write a tuple to its partition
+   * @param spill the partitions of a child, created by the first tuple
+   * @param td the schema of the child
+   * @param field the join field of the child
+   */
+  void spill(Spill &spill, const TupleDesc &td, size_t field, size_t depth, const Tuple &t);
+
+  /// Add the pairs of partitions with tuples on both sides to the pending partitions
+  void addPartitions(Spill lefts, Spill rights, size_t depth);
+
+  /// Start probing the next pending partition that fits in memory, partitioning the others again
+  bool nextPartition();
+
+public:
+  /**
+   * @param left the operator streamed through the table
+   * @param right the operator the table is built from
+   * @param pred the equality
+   * @param memory the memory budget of the table, in bytes of serialized right tuples
+   */
+  HashJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred,
+           size_t memory = DEFAULT_JOIN_MEMORY);
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+
+  /**
+   * @brief Get what the last run of the join wrote to temporary partitions
+   */
+  const Stats &getStats() const;
+};
+
+/**
+ * @brief An in-memory equi-join that partitions both children on the hash of the join field, so that the table of each
+ * partition fits in the CPU cache (radix join).
+ * @details The right child is read into memory, and each of its tuples gets an entry of the hash of its join field and
+ * its position. The entries are scattered to 2^bits partitions by the top bits of the hash, with enough bits that a
+ * partition holds about RADIX_JOIN_PARTITION_TUPLES tuples, up to 2 * RADIX_JOIN_PASS_BITS bits. Past
+ * RADIX_JOIN_PASS_BITS bits, the scatter is split in two passes of half the bits, so that a pass does not write to
+ * more pages than the TLB covers. Each scatter collects
+ * the entries of a partition in a buffer of a cache line, and writes the partition a whole line at a time (software
+ * write-combining). The entries of each partition then fill a linear-probing table. The left child is read in chunks
+ * of RADIX_JOIN_CHUNK tuples that are partitioned the same way, and each of their partitions probes the table of its
+ * right partition. The tables are built and probed by several threads, one partition at a time.
+ * @throws std::logic_error if the join predicate is not an equality.
+ */
+class RadixJoin : public Join {
+public:
+  /// The right tuples of a partition: a half full table of 16-byte entries fits in 256KB of L2 cache
+  static constexpr size_t RADIX_JOIN_PARTITION_TUPLES = 1 << 13;
+  static constexpr unsigned RADIX_JOIN_PASS_BITS = 8;
+  static constexpr size_t RADIX_JOIN_CHUNK = 1 << 16;
+
+  /**
+   * @brief The hash of the join field of a tuple and its position.
+   */
+  struct Entry {
+    uint64_t hash;
+    size_t row;
+  };
+
+private:
+  size_t threads;
+  size_t partition_tuples;
+
+  /// The number of bits of the hash that pick the partition
+  unsigned bits = 0;
+
+  std::vector<Tuple> rights;
+
+  /// The tables of the partitions, one after another; a slot whose row is `EMPTY` is free
+  static constexpr size_t EMPTY = SIZE_MAX;
+  std::vector<Entry> slots;
+  std::vector<size_t> table_offsets;
+
+  /// The chunk of left tuples and the pairs of left and right positions that it joins
+  std::vector<Tuple> lefts;
+  std::vector<std::pair<size_t, size_t>> pairs;
+  size_t pair = 0;
+  bool left_done = true;
+
+  /**
+   * @brief Reorder entries by partition
+   * @return the position of the first entry of each partition, and the number of entries
+   */
+  std::vector<size_t> partition(std::vector<Entry> &entries) const;
+
+  /// Join the next chunk of left tuples
+  void probeChunk();
+
+public:
+  /**
+   * @param left the operator that probes the tables
+   * @param right the operator the tables are built from
+   * @param pred the equality
+   * @param threads the number of threads that build and probe the tables
+   * @param partition_tuples the number of right tuples to aim for in a partition
+   */
+  RadixJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred,
+            size_t threads = std::thread::hardware_concurrency(),
+            size_t partition_tuples = RADIX_JOIN_PARTITION_TUPLES);
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+
+  /**
+   * @brief Get the number of bits of the hash that partition the last run of the join
+   */
+  unsigned getBits() const;
+};
+
+/**
+ * @brief A join of two children sorted in ascending order of their join fields (sort-merge join).
+ * @details For an equality, both children are read once, side by side. The right tuples with the join value of the
+ * current left tuple are kept in memory, so that runs of duplicates on both sides produce every pair, and are reused
+ * by the following left tuples with the same value. For LT, LE, GT and GE, the right child is read into memory once.
+ * The right tuples that match a left tuple are then a suffix (LT, LE) or a prefix (GT, GE) of them, whose boundary
+ * only moves forward as the left values increase: each left tuple produces its matches without comparing them, and
+ * the boundary moves past each right tuple once. The children must be sorted, e.g. scans of BTreeFiles keyed on the
+ * join fields or of files sorted with db::sort; otherwise the result is incomplete.
+ * @throws std::logic_error if the join predicate is NE.
+ */
+class MergeJoin : public Join {
+  /// The run of right tuples with the current join value for an equality, and every right tuple otherwise
+  std::vector<Tuple> run;
+
+  /// The first right tuple past the run, for an equality
+  std::optional<Tuple> next_right;
+
+  /// The boundary of the matches in `run`, and the next match of `current`
+  size_t begin = 0;
+  size_t end = 0;
+  size_t pos = 0;
+
+  /// Set the matches in `run` of a new left tuple
+  void seek(const field_t &key);
+
+public:
+  MergeJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred);
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief An equi-join that looks up the join value of each left tuple in a BTreeFile keyed on the right join field
+ * (index nested-loop join).
+ * @details The left child is read in batches of up to `batch` tuples. The int join values of a batch are looked up
+ * together with BTreeFile::multiGet, which sorts them and descends the tree once: the index pages and leaves that
+ * several values share are read once. The tuples of a batch are then produced in order with their matches. Only the
+ * leaves that hold left values are read, so the join beats a scan of the tree when the left child is small.
+ * @throws std::logic_error if the join predicate is not an equality on the key of the tree.
+ */
+class IndexJoin : public Join {
+  const BTreeFile &index;
+  size_t batch;
+
+  /// The left tuples of the batch, and the right tuples with their join values, in key order
+  std::vector<Tuple> lefts;
+  std::vector<Tuple> matches;
+  std::vector<int> match_keys;
+
+  /// The left tuple being joined, and the range of its matches that were not produced yet
+  size_t l = 0;
+  size_t pos = 0;
+  size_t end = 0;
+
+  /// Read the next batch of left tuples and look up their join values
+  bool nextBatch();
+
+public:
+  static constexpr size_t INDEX_JOIN_BATCH = 1024;
+
+  /**
+   * @param left the operator whose join values are looked up
+   * @param index the tree that the right tuples are read from
+   * @param pred the equality
+   * @param batch the number of left tuples whose values are looked up together
+   */
+  IndexJoin(std::unique_ptr<Operator> left, const BTreeFile &index, JoinPredicate pred,
+            size_t batch = INDEX_JOIN_BATCH);
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief A join with any predicate that reads the right child once per block of left tuples (block nested-loop join).
+ * @details The left child is read in blocks of as many tuples as fit in the memory budget. The right child is then
+ * read once for the whole block, instead of once per left tuple. The join values of a block are kept in vec::Columns
+ * of up to vec::BATCH_SIZE values, so each right tuple is compared with a block column by column with vec::select,
+ * a tight loop over an `int` or `double` array, and is produced with each left tuple it matches.
+ */
+class BlockJoin : public Join {
+  size_t memory;
+
+  /// The left tuples of the block, and their join values
+  std::vector<Tuple> block;
+  std::vector<vec::Column> keys;
+
+  /// The right tuple being joined, and the positions in the block of the left tuples it matches
+  std::optional<Tuple> inner;
+  std::vector<uint32_t> matches;
+  size_t pos = 0;
+
+  size_t blocks = 0;
+
+  /// Read the next block of left tuples
+  bool nextBlock();
+
+  /// Find the left tuples of the block that match `inner`
+  void match();
+
+public:
+  /**
+   * @param memory the memory budget of a block, in bytes of serialized left tuples; a block holds at least one tuple
+   */
+  BlockJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred,
+            size_t memory = DEFAULT_JOIN_MEMORY);
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+
+  /**
+   * @brief Get the number of blocks of the last run of the join, which is the number of times it read the right child
+   */
+  size_t getBlocks() const;
+};
+
+} // namespace db::op
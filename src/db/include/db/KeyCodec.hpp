@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <db/KeySearch.hpp>
+#include <db/Tuple.hpp>
+#include <string>
+
+namespace db {
+
+/**
+ * @brief The key of a BTreeFile that is a single INT field.
+ * @details The pages store the keys as arrays of int that are searched with the kernels of KeySearch.hpp. Every
+ * operation is known at compile time, so trees with int keys do not pay for the generic key support.
+ */
+struct IntKey {
+  /// The type of a key outside of a page
+  using key_type = int;
+
+  /// The type of the elements of the key arrays of a page; a key takes `stride()` elements
+  using slot_type = int;
+
+  /// The index of the key in the tuple
+  size_t index;
+
+  IntKey(size_t index = 0) : index(index) {}
+
+  static constexpr size_t stride() { return 1; }
+
+  size_t count() const { return 1; }
+
+  size_t field(size_t) const { return index; }
+
+  key_type extract(const Tuple &t) const { return std::get<int>(t.get_field(index)); }
+
+  key_type encode(const std::vector<field_t> &values) const { return std::get<int>(values.at(0)); }
+
+  static key_type load(const slot_type *key) { return *key; }
+
+  static void store(slot_type *dst, key_type key) { *dst = key; }
+
+  static int compare(key_type key, const slot_type *other) { return (key > *other) - (key < *other); }
+
+  static size_t lower_bound(const slot_type *keys, size_t n, key_type key) { return search::lower_bound(keys, n, key); }
+
+  static size_t upper_bound(const slot_type *keys, size_t n, key_type key) { return search::upper_bound(keys, n, key); }
+};
+
+/**
+ * @brief The key of a BTreeFile made of one or more fields of any type.
+ * @details A key is stored as a normalized string of bytes that compares with memcmp in the same order as the values:
+ * an INT is stored big-endian with its sign bit flipped, a DOUBLE is stored big-endian with its sign bit flipped if it
+ * is positive and all its bits flipped if it is negative, and a CHAR is stored as its CHAR_SIZE zero padded bytes. The
+ * fields are concatenated, so a composite key is ordered by its first field, then by its second field, and so on.
+ */
+class NormalizedKey {
+  static constexpr size_t MAX_FIELDS = 8;
+
+  std::array<size_t, MAX_FIELDS> fields;
+  std::array<type_t, MAX_FIELDS> types;
+  size_t num_fields;
+  size_t width;
+
+  void encode(uint8_t *dst, size_t i, const field_t &value) const;
+
+public:
+  /// Keys are kept as normalized strings of `stride()` bytes, which compare like the values they encode
+  using key_type = std::string;
+
+  using slot_type = uint8_t;
+
+  /**
+   * @brief Initialize a key over fields of a tuple
+   * @param td the tuple descriptor
+   * @param fields the indexes of the fields of the key, from the most to the least significant
+   * @throws std::logic_error if there are no fields, too many fields, or a field is out of range
+   */
+  NormalizedKey(const TupleDesc &td, const std::vector<size_t> &fields);
+
+  size_t stride() const { return width; }
+
+  size_t count() const { return num_fields; }
+
+  size_t field(size_t i) const { return fields[i]; }
+
+  key_type extract(const Tuple &t) const;
+
+  /**
+   * @brief Encode the values of the key fields
+   * @param values the values, one for every field of the key
+   * @throws std::logic_error if the number or the types of the values do not match the fields
+   */
+  key_type encode(const std::vector<field_t> &values) const;
+
+  key_type load(const slot_type *key) const;
+
+  void store(slot_type *dst, const key_type &key) const;
+
+  int compare(const key_type &key, const slot_type *other) const;
+
+  size_t lower_bound(const slot_type *keys, size_t n, const key_type &key) const;
+
+  size_t upper_bound(const slot_type *keys, size_t n, const key_type &key) const;
+};
+
+} // namespace db
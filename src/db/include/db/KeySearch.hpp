@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Search kernels for the sorted int keys of index and leaf pages.
+ * @details A branchless binary search narrows the range down to a window of a few cache lines, and the keys of the
+ * window are then counted with AVX2 compares and movemask. The AVX2 kernels are selected at runtime when the CPU
+ * supports them; otherwise the window is counted with a scalar branchless loop.
+ */
+namespace db::search {
+
+/**
+ * @brief Find the first of `n` sorted keys that is not less than `key`.
+ * @return the position of the key, or `n` if every key is less than `key`
+ */
+size_t lower_bound(const int *keys, size_t n, int key);
+
+/**
+ * @brief Find the first of `n` sorted keys that is greater than `key`.
+ * @return the position of the key, or `n` if no key is greater than `key`
+ */
+size_t upper_bound(const int *keys, size_t n, int key);
+
+/**
+ * @brief Find the first of `n` sorted keys that is not less than `key`, where key `i` is stored at `base + i * stride`.
+ */
+size_t lower_bound(const uint8_t *base, size_t stride, size_t n, int key);
+
+/**
+ * @brief Find the first of `n` sorted keys that is greater than `key`, where key `i` is stored at `base + i * stride`.
+ */
+size_t upper_bound(const uint8_t *base, size_t stride, size_t n, int key);
+
+} // namespace db::search
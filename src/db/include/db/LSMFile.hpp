@@ -0,0 +1,210 @@
+#pragma once
+
+#include <db/BloomFilter.hpp>
+#include <db/DbFile.hpp>
+#include <map>
+#include <optional>
+
+namespace db {
+
+/// The number of pages of the memtable of an LSMFile, once written as a run
+constexpr size_t DEFAULT_MEMTABLE_PAGES = 16;
+
+struct RunInfo {
+  /// The first page of the run; the pages of a run are contiguous
+  size_t first;
+
+  /// The number of pages of the run
+  size_t pages;
+
+  /// The size in bytes of the Bloom filter of the keys of the run, stored in the pages after the run, or 0
+  size_t filter_size;
+
+  /// The level of the run (0 for runs written from the memtable)
+  size_t level;
+};
+
+struct LSMFileHeader {
+  /// The number of runs
+  size_t num_runs;
+
+  /// The runs, from the newest to the oldest
+  RunInfo runs[(DEFAULT_PAGE_SIZE - sizeof(size_t)) / sizeof(RunInfo)];
+};
+
+static_assert(sizeof(LSMFileHeader) <= DEFAULT_PAGE_SIZE);
+
+/**
+ * @brief A log-structured merge tree of tuples with a unique int key.
+ * @details Inserts and deletes go to an in-memory sorted memtable. When the memtable is full, it is written as an
+ * immutable sorted run of contiguous pages, and a delete is written as a tombstone. Runs are never modified: they are
+ * written sequentially, directly to the file and without going through the BufferPool, so writes are bounded by
+ * sequential I/O.
+ * The runs are organized in levels with leveled compaction. Level 0 holds up to `L0_RUNS` runs written from the
+ * memtable, whose keys may overlap; when it is full, its runs are merged with the single run of level 1. A level `i > 0`
+ * holds a single run of at most `L0_RUNS * LEVEL_FANOUT^(i-1)` memtables, and is merged into the next level when it
+ * grows larger. A merge keeps the newest entry of each key, and drops tombstones when it writes the last level.
+ * Each run is followed by a blocked Bloom filter of its keys, so that a lookup skips the runs that do not hold its key
+ * without reading them; the filters are kept in memory.
+ * The first page of the file lists the runs, and is written after the runs it lists, so the file always describes
+ * complete runs. Space freed by merges is reused by later runs, once a written header no longer lists the merged runs.
+ *  An iterator is positioned on a key rather than a page: the tuples are read in key order, as the merged view of the
+ * memtable and the runs where the newest entry of each key wins.
+ */
+class LSMFile : public DbFile {
+  struct Run {
+    RunInfo info;
+
+    /// The first key of every page, to find the page of a key without reading the run
+    std::vector<int> fences;
+
+    /// The filter of the keys of the run, tombstones included
+    std::optional<BloomFilter> filter;
+  };
+
+  size_t key_index;
+  size_t memtable_pages;
+  size_t bloom_bits_per_key;
+  mutable BloomCounters bloom_stats;
+
+  /// The number of entries of a full memtable
+  size_t memtable_capacity;
+
+  /// The tuples that were not written yet; a deleted key maps to nothing
+  std::map<int, std::optional<Tuple>> memtable;
+
+  /// The runs, from the newest to the oldest: level 0 from the newest, then every deeper level
+  std::vector<Run> runs;
+
+  /// The runs listed by the header on disk, whose pages are not reused until the next header is written
+  std::vector<RunInfo> written;
+
+  /**
+   * @brief Get the number of pages of a run and of its filter.
+   * @param entries the largest number of entries of the run
+   */
+  size_t runPages(size_t entries) const;
+
+  /**
+   * @brief Find a free range of pages for a new run.
+   * @details The range is the first gap between the runs, and the runs listed by the header on disk, that is large
+   * enough, or else the end of the file.
+   * @param pages the number of pages of the range
+   * @return the first page of the range
+   */
+  size_t allocate(size_t pages);
+
+  /**
+   * @brief Write the list of runs to the first page.
+   */
+  void writeHeader();
+
+  /**
+   * @brief Merge the runs of a level into the run of the next level, and continue with the next level if it is full.
+   * @param level the level
+   */
+  void compact(size_t level);
+
+  /**
+   * @brief Get the page of a run that may contain a key.
+   * @return the position of the page in the run, or nothing if the key is less than every key of the run
+   */
+  static std::optional<size_t> findPage(const Run &run, int key);
+
+  /**
+   * @brief Get the newest entry of a key.
+   * @details The page of a run is only read if the filter of the run may contain the key.
+   * @return nothing if the key was never inserted, an empty tuple for a tombstone, or else the tuple
+   */
+  std::optional<std::optional<Tuple>> findEntry(int key) const;
+
+  /**
+   * @brief Get the smallest key of a run or of the memtable that is greater than (or equal to) a key.
+   * @param key the key to start from
+   * @param inclusive whether to include `key` itself
+   * @return the key, or nothing if every key is smaller
+   */
+  std::optional<int> successor(int key, bool inclusive) const;
+
+  Iterator position(std::optional<int> key) const;
+
+public:
+  /// The number of runs of level 0 that trigger a compaction
+  static constexpr size_t L0_RUNS = 4;
+
+  /// The ratio of the sizes of consecutive levels
+  static constexpr size_t LEVEL_FANOUT = 10;
+
+  /**
+   * @brief Initialize an LSMFile
+   * @details If the file exists, its runs are read from the first page.
+   * @param key_index the index of the key in the tuple
+   * @param memtable_pages the size of the memtable, in pages of the runs it is written to
+   * @param bloom_bits_per_key the number of bits per key of the Bloom filters of new runs, or 0 for no filters
+   * @throws std::logic_error if the key is not an int
+   */
+  LSMFile(const std::string &name, const TupleDesc &td, size_t key_index,
+          size_t memtable_pages = DEFAULT_MEMTABLE_PAGES, size_t bloom_bits_per_key = DEFAULT_BLOOM_BITS_PER_KEY);
+
+  /**
+   * @brief Insert a tuple into the file
+   * @details The tuple replaces any tuple with the same key. It is added to the memtable, which is written as a run if
+   * it is full.
+   * @param t the tuple to insert
+   * @throws std::runtime_error if the tuple is not compatible with the TupleDesc
+   */
+  void insertTuple(const Tuple &t) override;
+
+  /**
+   * @brief Delete a tuple from the file
+   * @details A tombstone for the key of the tuple is added to the memtable.
+   * @param it the iterator to the tuple
+   */
+  void deleteTuple(const Iterator &it) override;
+
+  /**
+   * @brief Get the tuple that an iterator is positioned on.
+   * @throws std::out_of_range if there is no tuple with the key of the iterator
+   */
+  Tuple getTuple(const Iterator &it) const override;
+
+  /**
+   * @brief Advance the iterator to the tuple with the next key, skipping deleted keys.
+   */
+  void next(Iterator &it) const override;
+
+  Iterator begin() const override;
+
+  Iterator end() const override;
+
+  /**
+   * @brief Get the tuple with the given key.
+   * @details The memtable is searched first, then the runs from the newest to the oldest, reading at most one page of
+   * each run whose filter may contain the key.
+   * @param key the key to search for
+   * @return the tuple, or nothing if there is no tuple with this key
+   */
+  std::optional<Tuple> lookup(int key) const;
+
+  /**
+   * @brief Write the memtable as a run of level 0, compacting the levels that become full.
+   * @note The memtable is not persisted otherwise; flush before the file is removed from the Database.
+   */
+  void flush();
+
+  /**
+   * @brief Get the runs, from the newest to the oldest
+   */
+  std::vector<RunInfo> getRuns() const;
+
+  /**
+   * @brief Get the counters of the Bloom filters of the runs
+   */
+  BloomStats getBloomStats() const;
+
+  /**
+   * @brief Get the index of the key in the tuple
+   */
+  size_t getKeyIndex() const;
+};
+} // namespace db
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <db/Tuple.hpp>
+#include <db/KeyCodec.hpp>
 
 namespace db {
 
@@ -12,51 +12,125 @@ struct LeafPageHeader {
   uint16_t size;
 };
 
-struct LeafPage {
+template <class K> struct BasicLeafPage {
+  using key_type = typename K::key_type;
+  using slot_type = typename K::slot_type;
+
   const TupleDesc &td;
 
-  /// The index of the key in a tuple (the key field should be of type int)
-  const size_t key_index;
+  /// The key fields of a tuple
+  const K codec;
 
   uint16_t capacity;
 
   LeafPageHeader *header;
+
+  /// The upper bound (exclusive) of the keys of the page, only valid if the page has a next leaf
+  slot_type *high_key;
+
+  /// The keys of the tuples, sorted in ascending order; each key takes `codec.stride()` elements
+  slot_type *keys;
+
+  /// The position of each tuple in `data`, in the order of `keys`
+  uint16_t *slots;
+
+  /// The tuples, in no particular order. The first `size` positions are occupied.
   uint8_t *data;
 
   /**
    * @brief Initialize a leaf page
    *
-   * @details The provided page has a header of type LeafPageHeader, followed by a sequence of tuples.
+   * @details The provided page has a header of type LeafPageHeader, followed by the high key, a dense array of
+   * `capacity` sorted keys,
+   * an array of `capacity` slots that map each key to the position of its tuple, and the tuples.
+   * Searching and splitting only touch the keys and slots; inserting shifts the keys and slots but not the tuples.
    * The capacity of the page is calculated based on the remaining size of the page and the size of the tuples.
    *
    * @param page the page contents
    * @param td the tuple descriptor
-   * @param key_index the index of the key in the tuple
+   * @param codec the key of the tuples (for int keys, the index of the key in the tuple)
    */
-  LeafPage(Page &page, const TupleDesc &td, size_t key_index);
+  BasicLeafPage(Page &page, const TupleDesc &td, const K &codec);
 
   /**
    * @brief Insert a tuple into the page
    * @details The tuple is inserted in sorted order based on the key. If the key already exists, the previous tuple is replaced.
+   * @param t the tuple to insert
+   * @param unique whether keys are unique; if not, the tuple is inserted after the tuples with the same key
    * @return true if the leaf is full and needs to be split.
    */
-  bool insertTuple(const Tuple &t);
+  bool insertTuple(const Tuple &t, bool unique = true);
+
+  /**
+   * @brief Delete a tuple from the page
+   * @details The keys and slots after the tuple are shifted, and the tuple stored at the last occupied position is moved
+   * to the freed position.
+   * @param slot the slot of the tuple to delete
+   */
+  void deleteTuple(size_t slot);
+
+  /**
+   * @brief Check whether a key belongs to a leaf to the right of this page
+   * @param key the key to check
+   * @param lower whether the key is searched in the leftmost leaf that may contain it, which can hold keys equal to the
+   * high key if keys are not unique
+   * @return true if the page has a next leaf and the key is not less than (if `lower`, greater than) the high key
+   */
+  bool pastHighKey(const key_type &key, bool lower = false) const;
 
   /**
    * @brief Split the leaf page
    * @details The page is split into two pages. The old page contains the first half of the tuples, and the new page contains the second half.
+   * The new page inherits the next leaf and the high key of the old page, and the split key becomes the high key of
+   * the old page.
    * @param new_page a new empty page
+   * @param fill the fraction of the tuples that stay in the old page
    * @return the split key (the first key of the new page)
    */
-  int split(LeafPage &new_page);
+  key_type split(BasicLeafPage &new_page, double fill = 0.5);
 
   /**
-   * @brief Get a tuple from the database file.
-   * @details Get a tuple from the database file by reading the tuple from the page.
-   * @param it The iterator that identifies the tuple to be read.
+   * @brief Get a tuple from the page.
+   * @param slot The position of the tuple in key order.
    * @return The tuple read from the page.
    */
   Tuple getTuple(size_t slot) const;
+
+  /**
+   * @brief Get the key of a tuple without deserializing it.
+   * @param slot the position of the tuple in key order
+   * @return the key of the tuple
+   */
+  key_type getKey(size_t slot) const;
+
+  key_type getHighKey() const;
+
+  void setHighKey(const key_type &key);
+
+  /**
+   * @brief Find the first slot whose key is not less than the given key.
+   * @param key the key to search for
+   * @return the slot, or `header->size` if every key is less than `key`
+   */
+  size_t lower_bound(const key_type &key) const;
+
+  /**
+   * @brief Find the first slot of a range whose key is not less than the given key.
+   * @param key the key to search for
+   * @param lo the first slot of the range
+   * @param hi the slot after the range
+   * @return the slot, or `hi` if every key of the range is less than `key`
+   */
+  size_t lower_bound(const key_type &key, size_t lo, size_t hi) const;
+
+  /**
+   * @brief Find the first slot whose key is greater than the given key.
+   * @param key the key to search for
+   * @return the slot, or `header->size` if no key is greater than `key`
+   */
+  size_t upper_bound(const key_type &key) const;
 };
 
+using LeafPage = BasicLeafPage<IntKey>;
+
 } // namespace db
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace db {
+
+/// The default largest distance between the predicted and the actual position of a key
+constexpr size_t DEFAULT_LEARNED_ERROR = 32;
+
+/**
+ * @brief A piecewise-linear model of the positions of sorted int keys, with a bounded error.
+ * @details The model is built from the distinct keys in ascending order, each with the position of its first
+ * occurrence. Keys are grouped into segments greedily: a segment grows as long as a line through its first point stays
+ * within `max_error` positions of every point of the segment, which is tracked with the range of slopes that are still
+ * possible (a shrinking cone). A search finds the segment of a key with a binary search over the first keys of the
+ * segments, and predicts a small window of positions that contains the first position whose key is not less than it.
+ */
+class LearnedIndex {
+  struct Segment {
+    int key;
+    size_t pos;
+    double slope;
+  };
+
+  size_t max_error;
+  std::vector<Segment> segments;
+
+  /// The number of positions
+  size_t size = 0;
+
+  /// The range of slopes of the segment being built that keep every point within the error
+  double min_slope = 0;
+  double max_slope = 0;
+
+public:
+  /**
+   * @param max_error the largest distance between the predicted and the actual position of a key
+   */
+  explicit LearnedIndex(size_t max_error = DEFAULT_LEARNED_ERROR);
+
+  /**
+   * @brief Add a key to the model
+   * @param key the key; keys are added in strictly ascending order
+   * @param pos the position of the first occurrence of the key
+   */
+  void add(int key, size_t pos);
+
+  /**
+   * @brief Complete the model after the last key
+   * @param size the number of positions, so that `size` is the position after every key
+   */
+  void finish(size_t size);
+
+  /**
+   * @brief Predict the position of a key
+   * @return a window `[lo, hi)` of positions that contains the first position whose key is not less than `key`, unless
+   * it is after a run of more than `max_error` duplicates of a smaller key
+   */
+  std::pair<size_t, size_t> search(int key) const;
+
+  /**
+   * @brief Get the number of segments of the model
+   */
+  size_t getSegments() const;
+
+  /**
+   * @brief Get the size of the model in bytes
+   */
+  size_t getBytes() const;
+};
+} // namespace db
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+#include <db/Predicate.hpp>
+#include <db/Query.hpp>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Query operators that pass tuples to each other in memory.
+ * @details An operator produces tuples one at a time from `next`, pulling them from its children, so a tree of
+ * operators runs as a pipeline: only blocking operators (the build side of a join, an aggregate) hold tuples, and only
+ * a Sink writes to a DbFile. An operator is opened before the first `next`, can be opened again to restart it, and is
+ * closed after the last `next`.
+ */
+namespace db::op {
+
+/**
+ * @brief Get the schema of some fields of a schema.
+ * @details A field can be kept more than once; its copies are named `<name>.1`, `<name>.2`, ...
+ * @param td the schema
+ * @param fields the positions of the kept fields, in the order they should appear
+ */
+TupleDesc projectDesc(const TupleDesc &td, const std::vector<size_t> &fields);
+
+/**
+ * @brief Get the schema of the result of an aggregate.
+ * @details The fields are the group field, if any, followed by the value, named like `sum(price)`. The value of AVG is
+ * a double and the value of COUNT is an int; other values have the type of the summarized field.
+ * @param td the schema of the aggregated rows
+ * @param agg the aggregate
+ */
+TupleDesc aggregateDesc(const TupleDesc &td, const db::Aggregate &agg);
+
+class Operator {
+public:
+  virtual ~Operator() = default;
+
+  /**
+   * @brief Get the schema of the tuples produced by the operator
+   */
+  virtual const TupleDesc &getTupleDesc() const = 0;
+
+  /**
+   * @brief Prepare to produce the tuples from the first one.
+   */
+  virtual void open() = 0;
+
+  /**
+   * @brief Produce the next tuple
+   * @return the tuple, or nothing once every tuple was produced
+   */
+  virtual std::optional<Tuple> next() = 0;
+
+  /**
+   * @brief Release the state of the operator and of its children.
+   */
+  virtual void close() = 0;
+};
+
+/**
+ * @brief Reads the tuples of a file.
+ * @details The fields and the predicates that the tuples will be filtered with choose how the file is read: only the
+ * bucket of the key for an equality on the key of a HashFile; only the key range of a BTreeFile; or, for a HeapFile,
+ * the entries of a BTreeIndex that includes every field (an index-only scan, in key order) or the record ids of the
+ * range of a BTreeIndex, fetched in record id order. When a HeapFile is read entirely, the predicates that compare an
+ * INT or DOUBLE field with a value of the same type are evaluated on the bytes of each page, the other predicates are
+ * compiled and evaluated on the bytes of the tuples left, and only the tuples that satisfy every predicate are
+ * deserialized. Otherwise the predicates are not applied: tuples that do not satisfy them may still be produced.
+ */
+class Scan : public Operator {
+  const DbFile &file;
+  std::vector<FilterPredicate> pred;
+  TupleDesc td;
+
+  /// The positions of the produced fields in the file
+  std::vector<size_t> fields;
+
+  /// The positions of the produced fields in the tuples that are read, which are the entries of an index for an
+  /// index-only scan
+  std::vector<size_t> read;
+
+  /// The tuples of a hash bucket or of a page, or the record ids of an index range, if the file is not read in
+  /// iterator order
+  std::vector<Tuple> tuples;
+  std::vector<Iterator> rids;
+  size_t pos = 0;
+
+  /// The predicates that can be evaluated on the bytes of the pages of a HeapFile, and their fields
+  std::vector<size_t> page_pred;
+  std::vector<size_t> page_fields;
+
+  /// The other predicates, evaluated on the bytes of the tuples that satisfy the page predicates
+  CompiledPredicate page_rest;
+
+  /// The next page to read, if a HeapFile is read one page at a time
+  std::optional<size_t> page;
+
+  std::optional<Morsel> morsel;
+  std::optional<Iterator> it;
+
+  /// Set the tuples to the tuples of the next page that satisfy the page predicates
+  void readPage();
+
+public:
+  /**
+   * @param file the file to read
+   * @param field_names the fields to produce, in this order; all of them if empty
+   * @param pred the predicates that the tuples will be filtered with
+   */
+  explicit Scan(const DbFile &file, const std::vector<std::string> &field_names = {},
+                std::vector<FilterPredicate> pred = {});
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief Produces the tuples of its child that satisfy every predicate.
+ * @details The predicates are compiled for the schema of the child when the operator is created.
+ */
+class Filter : public Operator {
+  std::unique_ptr<Operator> child;
+  CompiledPredicate pred;
+
+public:
+  /**
+   * @param child the operator to read from
+   * @param pred the predicates, combined with a logical AND
+   * @param mode how the predicates are combined
+   * @param stats the histograms of some INT fields of the child, by field name, to order the predicates
+   */
+  Filter(std::unique_ptr<Operator> child, const std::vector<FilterPredicate> &pred,
+         EvalMode mode = EvalMode::SHORT_CIRCUIT, const CompiledPredicate::Stats &stats = {});
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief Produces some fields of the tuples of its child.
+ * @details A field can be kept more than once; its copies are named `<name>.1`, `<name>.2`, ...
+ */
+class Project : public Operator {
+  std::unique_ptr<Operator> child;
+  TupleDesc td;
+  std::vector<size_t> fields;
+
+public:
+  /**
+   * @param child the operator to read from
+   * @param field_names the fields to keep, in the order they should appear
+   */
+  Project(std::unique_ptr<Operator> child, const std::vector<std::string> &field_names);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief Produces the pairs of tuples of its children that satisfy a join predicate.
+ * @details The tuples are the fields of the left tuple followed by the fields of the right tuple, without the join
+ * field of the right tuple for an equality. A field of the right child whose name is also used by the left child is
+ * renamed `<name>.1`.
+ * For an equality, the right child is read once into an in-memory hash table on its join field, and the left child is
+ * streamed through it. Otherwise, the right child is read again for every left tuple. The other join algorithms of
+ * Join.hpp derive from this class to produce the same tuples.
+ */
+class Join : public Operator {
+protected:
+  std::unique_ptr<Operator> left;
+  std::unique_ptr<Operator> right;
+  JoinPredicate pred;
+  TupleDesc td;
+  size_t left_field;
+  size_t right_field;
+
+  /// The tuples of the right child by join field, for an equality
+  std::unordered_multimap<field_t, Tuple> table;
+
+  /// The left tuple being joined
+  std::optional<Tuple> current;
+
+  /// The right tuples that match `current` and were not produced yet, for an equality
+  std::unordered_multimap<field_t, Tuple>::const_iterator match;
+  std::unordered_multimap<field_t, Tuple>::const_iterator match_end;
+
+  /// The output tuple of a pair of tuples
+  Tuple concat(const Tuple &l, const Tuple &r) const;
+
+public:
+  Join(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, JoinPredicate pred);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief Groups the tuples of its child by a field and summarizes another field.
+ * @details The child is read entirely when the operator is opened. The tuples are (group, value), one per group in
+ * group order, or a single (value) tuple without a group. The value of AVG is a double and the value of COUNT is an
+ * int; other values have the type of the summarized field.
+ * @throws std::logic_error if SUM or AVG is applied to a CHAR field.
+ */
+class Aggregate : public Operator {
+  /**
+   * @brief The running state of an aggregate over the values of a group.
+   */
+  struct Accumulator {
+    field_t value;
+    int count = 0;
+
+    void add(const field_t &v, AggregateOp op);
+
+    field_t result(AggregateOp op) const;
+  };
+
+  std::unique_ptr<Operator> child;
+  db::Aggregate agg;
+  TupleDesc td;
+  size_t field;
+  std::optional<size_t> group;
+  std::map<field_t, Accumulator> groups;
+  std::map<field_t, Accumulator>::const_iterator pos;
+  bool empty_count = false;
+
+public:
+  Aggregate(std::unique_ptr<Operator> child, db::Aggregate agg);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+/**
+ * @brief Writes the tuples of an operator to a file.
+ */
+class Sink {
+  std::unique_ptr<Operator> child;
+  DbFile &out;
+
+public:
+  Sink(std::unique_ptr<Operator> child, DbFile &out);
+
+  /**
+   * @brief Run the operators and insert their tuples into the file
+   * @return the number of tuples written
+   */
+  size_t run();
+};
+
+} // namespace db::op
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <db/Query.hpp>
+
+/**
+ * @brief Predicate kernels over the fields of the slots of a page, read in place.
+ * @details The field of slot `i` is stored at `base + i * stride`, as the fields of a HeapPage are. The selected slots
+ * are a bitmap of 64 bit words, with slot `i` at bit `i % 64` of word `i / 64`. A kernel only keeps the slots of the
+ * bitmap whose field satisfies the predicate, so a conjunction is evaluated by applying each predicate to the bitmap of
+ * the occupied slots in turn, and words without any slot left are skipped. The fields of 8 INT or 4 DOUBLE slots are
+ * loaded with an AVX2 gather and compared at once when the CPU supports it; otherwise a scalar branchless loop builds
+ * the words.
+ */
+namespace db::pagefilter {
+
+/**
+ * @brief Get the number of words of a bitmap of `n` slots.
+ */
+constexpr size_t words(size_t n) { return (n + 63) / 64; }
+
+/**
+ * @brief Keep the selected slots whose INT field satisfies `field op value`.
+ * @param base the field of the first slot
+ * @param stride the distance between the fields of two consecutive slots
+ * @param n the number of slots
+ * @param bits the selected slots, `words(n)` words; the bits of slots `n` and after must be clear
+ * @return the number of selected slots left
+ */
+size_t select(const uint8_t *base, size_t stride, size_t n, PredicateOp op, int value, uint64_t *bits);
+
+/**
+ * @brief Keep the selected slots whose DOUBLE field satisfies `field op value`.
+ * @see select(const uint8_t *, size_t, size_t, PredicateOp, int, uint64_t *)
+ */
+size_t select(const uint8_t *base, size_t stride, size_t n, PredicateOp op, double value, uint64_t *bits);
+
+} // namespace db::pagefilter
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <db/ColumnStats.hpp>
+#include <db/Query.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace db {
+
+/**
+ * @brief Compare two values.
+ * @details Values of different types compare by the index of their type in `field_t`.
+ */
+bool compare(const field_t &lhs, PredicateOp op, const field_t &rhs);
+
+/**
+ * @brief Compare two values of the same type with an operation known at compile time.
+ */
+template <PredicateOp op, typename T> bool compare(const T &lhs, const T &rhs) {
+  if constexpr (op == PredicateOp::EQ) {
+    return lhs == rhs;
+  } else if constexpr (op == PredicateOp::NE) {
+    return lhs != rhs;
+  } else if constexpr (op == PredicateOp::LT) {
+    return lhs < rhs;
+  } else if constexpr (op == PredicateOp::LE) {
+    return lhs <= rhs;
+  } else if constexpr (op == PredicateOp::GT) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+/**
+ * @brief How a CompiledPredicate combines its terms.
+ * @details SHORT_CIRCUIT stops at the first term that is not satisfied, which evaluates fewer terms when the first terms
+ * reject most tuples. BRANCH_FREE evaluates every term and combines the outcomes with a bitwise AND. It does more work
+ * but does not branch on each outcome, so it avoids branch mispredictions when the terms keep about half of the tuples.
+ */
+enum class EvalMode { SHORT_CIRCUIT, BRANCH_FREE };
+
+/**
+ * @brief A conjunction of FilterPredicates bound to a schema.
+ * @details Compiling resolves the position and the offset of the field of every predicate once, and binds each one to
+ * an evaluator specialized for the type of the field and the operation, with the value converted to that type. The
+ * evaluators read a field either from a Tuple or from the bytes of a serialized tuple, so a tuple can be tested before
+ * it is deserialized. A predicate whose value has another type than its field compares by type, like `field_t` does:
+ * it is either always satisfied and dropped, or never satisfied.
+ * The terms are ordered to reject tuples as early and as cheaply as possible: by their cost (a CHAR comparison costs
+ * more than an INT or DOUBLE comparison) divided by the fraction of tuples they reject. The fraction is estimated from
+ * the ColumnStats of an INT field when there is one, and otherwise from the operation (1/10 of the tuples are equal to
+ * a value, and 1/3 of the tuples are in a range).
+ */
+class CompiledPredicate {
+  struct Term {
+    size_t field;
+    size_t offset;
+    int int_value = 0;
+    double double_value = 0;
+    std::string char_value;
+    bool (*tuple)(const Tuple &t, const Term &term);
+    bool (*bytes)(const uint8_t *data, const Term &term);
+  };
+
+  std::vector<Term> terms;
+
+  /// The position in the FilterPredicates of each term, in evaluation order
+  std::vector<size_t> order;
+
+  /// Whether a predicate can never be satisfied
+  bool never = false;
+  EvalMode mode = EvalMode::SHORT_CIRCUIT;
+
+  template <typename F> bool evaluate(F eval) const;
+
+public:
+  using Stats = std::unordered_map<std::string, ColumnStats>;
+
+  /**
+   * @brief A predicate that every tuple satisfies.
+   */
+  CompiledPredicate() = default;
+
+  /**
+   * @param td the schema of the tuples to test
+   * @param pred the predicates, combined with a logical AND
+   * @param mode how the terms are combined
+   * @param stats the histograms of some INT fields, by field name
+   */
+  CompiledPredicate(const TupleDesc &td, const std::vector<FilterPredicate> &pred,
+                    EvalMode mode = EvalMode::SHORT_CIRCUIT, const Stats &stats = {});
+
+  /**
+   * @brief Test a tuple
+   */
+  bool operator()(const Tuple &t) const;
+
+  /**
+   * @brief Test a serialized tuple
+   * @param data the bytes of the tuple, as written by TupleDesc::serialize
+   */
+  bool operator()(const uint8_t *data) const;
+
+  /**
+   * @brief Get the order in which the predicates are evaluated
+   * @return the positions of the predicates that are evaluated, in evaluation order
+   */
+  const std::vector<size_t> &getOrder() const;
+};
+
+} // namespace db
@@ -69,6 +69,8 @@ struct Aggregate {
  * @details A projection operation selects a subset of fields from the input table.
  *   The field_names specify the fields to keep, in the order they should appear.
  *   The output table is stored in the out table.
+ *   If the input is a HeapFile with a BTreeIndex that includes every kept field, only the index is scanned, and the
+ *   rows are produced in key order.
  * @param in The input table.
  * @param out The output table.
  * @param field_names The fields to keep.
@@ -80,6 +82,9 @@ void projection(const DbFile &in, DbFile &out, const std::vector<std::string> &f
  * @details A filter operation selects rows that satisfy a set of predicates.
  *   The predicates are combined with a logical AND.
  *   The output table is stored in the out table.
+ *   If the input is a HeapFile with a BTreeIndex over a field that the predicates restrict to a range, only the tuples
+ *   in that range are fetched, in record id order, or read from the index if it includes every field. If the input is
+ *   a HashFile and a predicate is an equality on its key, only the bucket of the key is read.
  * @param in The input table.
  * @param out The output table.
  * @param pred The predicates to filter rows.
@@ -90,6 +95,13 @@ void filter(const DbFile &in, DbFile &out, const std::vector<FilterPredicate> &p
  * @brief Perform a join operation.
  * @details A join operation combines rows from two tables that satisfy the join predicates.
  *   The output table is stored in the out table.
+ *   An equality join whose right table is a BTreeFile keyed on the join field, and whose left table has fewer tuples
+ *   than the tree has pages, looks up the left join values in the tree. An equality join of two BTreeFiles keyed on
+ *   the join fields, and a LT, LE, GT or GE join whose right table fits in half of the buffer pool, merge the tables in
+ *   the order of the join fields; a table that is not a BTreeFile keyed on its join field is sorted first. Another
+ *   equality join is a radix-partitioned hash join in memory when the right table fits in half of the buffer pool, and
+ *   otherwise a hash join that spills partitions of both tables to temporary files. A NE join, and a larger LT, LE, GT
+ *   or GE join, read the right table once per block of left tuples that fit in half of the buffer pool.
  * @param left The left table.
  * @param right The right table.
  * @param out The output table.
@@ -104,12 +116,26 @@ void join(const DbFile &left, const DbFile &right, DbFile &out, const JoinPredic
  * @details An aggregate operation groups rows by a field and summarizes the values of another field.
  *   The output table is stored in the out table.
  *   If the group field is not specified, the aggregate is performed on all rows and returns a single tuple with one field.
- *   Otherwise, the aggregate is performed on each unique group and returns one tuple per group.
+ *   Otherwise, the aggregate is performed on each unique group and returns one tuple per group, in group order.
+ *   If the input is a HeapFile with a BTreeIndex that includes the aggregated and the group fields, only the index is
+ *   scanned.
  * @param in The input table.
  * @param out The output table.
  * @param agg The aggregate operation.
+ * @throws std::logic_error if SUM or AVG is applied to a CHAR field.
  * @note The computed value should have the same type as the field being aggregated with the exception of AVG which should return a double.
  */
 void aggregate(const DbFile &in, DbFile &out, const Aggregate &agg);
 
+/**
+ * @brief Perform an external sort.
+ * @details The input table is read in chunks that fit in half of the bufferpool. Each chunk is sorted in memory and
+ *   written to a temporary run. The runs are then merged, at most half a bufferpool of runs at a time, until a single
+ *   merge writes the sorted rows to the out table. Rows with equal values keep their input order.
+ * @param in The input table.
+ * @param out The output table.
+ * @param field The field to sort by.
+ */
+void sort(const DbFile &in, DbFile &out, const std::string &field);
+
 } // namespace db
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+
+namespace db {
+
+struct RunPageHeader {
+  /// The number of entries in the page
+  uint16_t size;
+};
+
+/**
+ * @brief A page of a sorted run of an LSMFile.
+ * @details An entry is a tuple or a tombstone that marks its key as deleted. The entries are appended in key order and
+ * never modified, since runs are immutable.
+ */
+struct RunPage {
+  const TupleDesc &td;
+
+  uint16_t capacity;
+
+  RunPageHeader *header;
+
+  /// The keys of the entries, sorted in ascending order
+  int *keys;
+
+  /// Whether each entry is a tombstone
+  uint8_t *tombstones;
+
+  /// The tuples, in the order of `keys`; the tuple of a tombstone is unused
+  uint8_t *data;
+
+  /**
+   * @brief Initialize a run page
+   * @details The provided page has a header of type RunPageHeader, followed by an array of `capacity` keys, an array of
+   * `capacity` tombstone flags and the tuples. The capacity of the page is calculated based on the remaining size of the
+   * page and the size of the tuples.
+   * @param page the page contents
+   * @param td the tuple descriptor
+   */
+  RunPage(Page &page, const TupleDesc &td);
+
+  bool full() const { return header->size == capacity; }
+
+  /**
+   * @brief Append an entry with a key greater than the keys of the page
+   * @param key the key of the entry
+   * @param t the tuple, or nullptr for a tombstone
+   */
+  void append(int key, const Tuple *t);
+
+  /**
+   * @brief Append an entry of another run page with a key greater than the keys of the page
+   * @param other the page of the entry
+   * @param slot the position of the entry in `other`
+   */
+  void append(const RunPage &other, size_t slot);
+
+  /**
+   * @brief Get a tuple from the page.
+   * @param slot The position of the entry.
+   * @return The tuple read from the page.
+   * @throws std::out_of_range if the slot is not occupied
+   */
+  Tuple getTuple(size_t slot) const;
+
+  /**
+   * @brief Find the first entry whose key is not less than the given key.
+   * @return the position of the entry, or `header->size` if every key is less than `key`
+   */
+  size_t lower_bound(int key) const;
+
+  /**
+   * @brief Find the first entry whose key is greater than the given key.
+   * @return the position of the entry, or `header->size` if no key is greater than `key`
+   */
+  size_t upper_bound(int key) const;
+};
+
+} // namespace db
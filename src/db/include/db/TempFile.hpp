@@ -0,0 +1,31 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+
+namespace db {
+
+/**
+ * @brief A HeapFile that holds intermediate results.
+ * @details The file is created with a unique name and added to the Database. On destruction, its pages are discarded
+ * from the BufferPool, and the file is removed from the Database and deleted from disk.
+ */
+class TempFile {
+  std::string name;
+
+public:
+  /**
+   * @brief Create a temporary file
+   * @param prefix the prefix of the file name (a unique suffix is appended)
+   * @param td the tuple descriptor of the file
+   */
+  TempFile(const std::string &prefix, const TupleDesc &td);
+
+  ~TempFile();
+
+  TempFile(const TempFile &) = delete;
+
+  TempFile &operator=(const TempFile &) = delete;
+
+  DbFile &file() const;
+};
+} // namespace db
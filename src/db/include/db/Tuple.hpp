@@ -59,6 +59,22 @@ public:
    */
   size_t index_of(const std::string &name) const;
 
+  /**
+   * @brief Get the name of the field
+   * @param index the index of the field
+   * @return the name of the field
+   * @throws std::out_of_range if the index is out of range
+   */
+  const std::string &name_of(size_t index) const;
+
+  /**
+   * @brief Get the type of the field
+   * @param index the index of the field
+   * @return the type of the field
+   * @throws std::out_of_range if the index is out of range
+   */
+  type_t type_of(size_t index) const;
+
   /**
    * @brief Get the number of fields in the TupleDesc
    * @return the number of fields in the TupleDesc
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <db/Operator.hpp>
+#include <memory>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Query operators that pass batches of rows to each other, column by column.
+ * @details A batch holds up to BATCH_SIZE rows, with the values of each field in an array of the type of the field, so
+ * that comparing, summing, ... the values of a field is a tight loop over an `int` or `double` array that the compiler
+ * can vectorize, instead of a dispatch on the type of a `field_t` for every value. Filtering a batch only shrinks its
+ * selection vector; the values are not moved. The operators follow the open / next / close protocol of db::op, and Rows
+ * turns the batches back into tuples so that a vectorized plan can feed an op::Sink or any other db::op operator.
+ */
+namespace db::vec {
+
+/// The maximum number of rows of a batch
+constexpr size_t BATCH_SIZE = 1024;
+
+/**
+ * @brief The values of a field for the rows of a batch.
+ * @details Only the array of the type of the field is used.
+ */
+struct Column {
+  type_t type;
+  std::vector<int> ints;
+  std::vector<double> doubles;
+  std::vector<std::string> chars;
+
+  explicit Column(type_t type);
+
+  /**
+   * @brief Remove every value, keeping the capacity of the array
+   */
+  void clear();
+
+  /**
+   * @brief Append a value
+   * @param value a value of the type of the column
+   */
+  void push(const field_t &value);
+
+  field_t get(size_t row) const;
+};
+
+/**
+ * @brief Rows stored column by column.
+ * @details The rows of the batch are the rows of the columns listed, in increasing order, in the selection vector. The
+ * other rows were filtered out.
+ */
+struct Batch {
+  std::vector<Column> columns;
+  std::vector<uint16_t> sel;
+
+  /// The number of rows in the columns, selected or not
+  size_t rows = 0;
+
+  /**
+   * @brief Remove every row and make the columns match a schema
+   */
+  void reset(const TupleDesc &td);
+
+  /**
+   * @brief Select every row of the columns
+   */
+  void selectAll();
+};
+
+/**
+ * @brief Select the rows of a column that satisfy a predicate.
+ * @details The values are compared like `field_t`s, so a value of another type than the column compares by type: every
+ * row or no row is selected.
+ * @param column the values to compare
+ * @param op the comparison
+ * @param value the value to compare with
+ * @param sel the rows to test, in increasing order
+ * @param n the number of rows to test
+ * @param out set to the rows that satisfy the predicate, in increasing order; may be `sel`
+ * @return the number of rows that satisfy the predicate
+ */
+size_t select(const Column &column, PredicateOp op, const field_t &value, const uint16_t *sel, size_t n, uint16_t *out);
+
+class Operator {
+public:
+  virtual ~Operator() = default;
+
+  /**
+   * @brief Get the schema of the rows produced by the operator
+   */
+  virtual const TupleDesc &getTupleDesc() const = 0;
+
+  /**
+   * @brief Prepare to produce the rows from the first one.
+   */
+  virtual void open() = 0;
+
+  /**
+   * @brief Produce the next batch
+   * @param batch reset and set to the next rows; no row may be selected
+   * @return false, with an empty batch, once every row was produced
+   */
+  virtual bool next(Batch &batch) = 0;
+
+  /**
+   * @brief Release the state of the operator and of its children.
+   */
+  virtual void close() = 0;
+};
+
+/**
+ * @brief Reads every tuple of a file into batches.
+ * @details The fields of a HeapFile are read directly from the bytes of its pages, one page pinned at a time; the
+ * tuples of other files are read through their iterators.
+ */
+class Scan : public Operator {
+  const DbFile &file;
+  TupleDesc td;
+
+  /// The positions of the produced fields in the file
+  std::vector<size_t> fields;
+
+  /// The page and slot of the next tuple of a HeapFile; the slot is the end of the page once it is read
+  size_t page = 0;
+  std::optional<size_t> slot;
+
+  std::optional<Iterator> it;
+
+public:
+  /**
+   * @param file the file to read
+   * @param field_names the fields to produce, in this order; all of them if empty
+   */
+  explicit Scan(const DbFile &file, const std::vector<std::string> &field_names = {});
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  bool next(Batch &batch) override;
+
+  void close() override;
+};
+
+/**
+ * @brief Selects the rows of its child that satisfy every predicate.
+ * @details The predicates are applied one after another, each one to the rows selected by the previous ones.
+ */
+class Filter : public Operator {
+  std::unique_ptr<Operator> child;
+  std::vector<FilterPredicate> pred;
+  std::vector<size_t> fields;
+
+public:
+  Filter(std::unique_ptr<Operator> child, std::vector<FilterPredicate> pred);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  bool next(Batch &batch) override;
+
+  void close() override;
+};
+
+/**
+ * @brief Produces some columns of the batches of its child.
+ * @details A field can be kept more than once; its copies are named `<name>.1`, `<name>.2`, ...
+ */
+class Project : public Operator {
+  std::unique_ptr<Operator> child;
+  TupleDesc td;
+  std::vector<size_t> fields;
+  Batch input;
+
+public:
+  /**
+   * @param child the operator to read from
+   * @param field_names the fields to keep, in the order they should appear
+   */
+  Project(std::unique_ptr<Operator> child, const std::vector<std::string> &field_names);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  bool next(Batch &batch) override;
+
+  void close() override;
+};
+
+/**
+ * @brief Groups the rows of its child by a field and summarizes another field.
+ * @details Produces the same rows as op::Aggregate. The rows of a batch are first mapped to the number of their group
+ * through a hash table typed like the group field, then the values are added to the state of their group by a loop
+ * typed like the summarized field; without a group, the values are reduced by a single loop.
+ * @throws std::logic_error if SUM or AVG is applied to a CHAR field.
+ */
+class Aggregate : public Operator {
+  template <typename T> using Groups = std::unordered_map<T, uint32_t>;
+
+  std::unique_ptr<Operator> child;
+  db::Aggregate agg;
+  TupleDesc td;
+  size_t field;
+  std::optional<size_t> group;
+
+  /// The number of each group by value, and the value of each group
+  std::variant<Groups<int>, Groups<double>, Groups<std::string>> ids;
+  std::vector<field_t> keys;
+
+  /// The sum, minimum or maximum of each group, and its number of rows
+  std::variant<std::vector<int>, std::vector<double>, std::vector<std::string>> values;
+  std::vector<int> counts;
+
+  /// The groups in output order, and the next one to produce
+  std::vector<uint32_t> order;
+  size_t pos = 0;
+  bool empty_count = false;
+
+  /// Set the group number of the selected rows of a batch, adding their new groups
+  void assign(const Batch &batch, std::vector<uint32_t> &gids);
+
+  void accumulate(const Batch &batch, const std::vector<uint32_t> &gids);
+
+  field_t result(uint32_t gid) const;
+
+public:
+  Aggregate(std::unique_ptr<Operator> child, db::Aggregate agg);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  bool next(Batch &batch) override;
+
+  void close() override;
+};
+
+/**
+ * @brief Produces the selected rows of the batches of a vectorized operator one tuple at a time.
+ */
+class Rows : public op::Operator {
+  std::unique_ptr<vec::Operator> child;
+  Batch batch;
+  size_t pos = 0;
+
+public:
+  explicit Rows(std::unique_ptr<vec::Operator> child);
+
+  const TupleDesc &getTupleDesc() const override;
+
+  void open() override;
+
+  std::optional<Tuple> next() override;
+
+  void close() override;
+};
+
+} // namespace db::vec
@@ -2,6 +2,7 @@
 #include <db/HeapPage.hpp>
 #include <db/HeapFile.hpp>
 #include <gtest/gtest.h>
+#include <thread>
 
 TEST(HeapPageTest, EmptyPage) {
   db::Page page{};
@@ -200,3 +201,78 @@ TEST(HeapFileTest, EmptyPage) {
     i++;
   }
 }
+
+TEST(HeapFileTest, Partition) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  constexpr size_t capacity = 53;
+  for (int i = 0; i < capacity * 10; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+  // leave the first page of the second half empty
+  auto it = file.begin();
+  it.page = 5;
+  for (int i = 0; i < capacity; ++i) {
+    it.slot = i;
+    file.deleteTuple(it);
+  }
+
+  auto morsels = file.partition(4);
+  EXPECT_EQ(morsels.size(), 4);
+  EXPECT_EQ(morsels.front().begin(), file.begin());
+  EXPECT_EQ(morsels.back().end(), file.end());
+  int i = 0;
+  for (const auto &morsel : morsels) {
+    for (const auto &t : morsel) {
+      if (i == capacity * 5) {
+        i += capacity;
+      }
+      EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+      i++;
+    }
+  }
+  EXPECT_EQ(i, capacity * 10);
+  EXPECT_EQ(file.partition(100).size(), file.getNumPages());
+}
+
+TEST(HeapFileTest, ParallelScan) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  constexpr int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+
+  auto morsels = file.partition(64);
+  std::atomic<size_t> next{0};
+  std::atomic<long> sum{0};
+  std::atomic<int> count{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (size_t m = next++; m < morsels.size(); m = next++) {
+        for (const auto &tuple : morsels[m]) {
+          sum += std::get<int>(tuple.get_field(0));
+          count++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(count, n);
+  EXPECT_EQ(sum, static_cast<long>(n) * (n - 1) / 2);
+}
@@ -1,6 +1,13 @@
+#include <atomic>
 #include <db/BTreeFile.hpp>
 #include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Query.hpp>
 #include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <span>
+#include <thread>
 
 TEST(BTreeTest, Empty) {
   const char *name = "test.db";
@@ -51,3 +58,593 @@ TEST(BTreeTest, Random) {
   }
   EXPECT_EQ(i, 1000000);
 }
+
+TEST(BTreeTest, Partition) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = db::getDatabase().get(name);
+  EXPECT_EQ(file.partition(8).size(), 1);
+  for (int i = 0; i < 100000; i++) {
+    int k = i % 2 ? 100000 - i : i;
+    db::Tuple t{{k, "apple", 1.0}};
+    file.insertTuple(t);
+  }
+
+  auto morsels = file.partition(8);
+  EXPECT_EQ(morsels.size(), 8);
+  EXPECT_EQ(morsels.front().begin(), file.begin());
+  EXPECT_EQ(morsels.back().end(), file.end());
+  int i = 0;
+  for (const auto &morsel : morsels) {
+    EXPECT_NE(morsel.begin(), morsel.end());
+    for (const auto &t : morsel) {
+      EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+      i++;
+    }
+  }
+  EXPECT_EQ(i, 100000);
+}
+
+TEST(BTreeTest, Find) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(file.find(0), file.end());
+  for (int i = 0; i < 100000; i++) {
+    int k = i % 2 ? 100000 - i : i;
+    db::Tuple t{{k * 2, "apple", 1.0}};
+    file.insertTuple(t);
+  }
+
+  for (int k = 0; k < 200000; k += 997) {
+    size_t reads = file.getReads().size();
+    auto it = file.find(k);
+    EXPECT_LE(file.getReads().size() - reads, 3);
+    if (k % 2) {
+      EXPECT_EQ(it, file.end());
+    } else {
+      ASSERT_NE(it, file.end());
+      EXPECT_EQ(std::get<int>((*it).get_field(0)), k);
+    }
+  }
+  EXPECT_EQ(file.find(-1), file.end());
+  EXPECT_EQ(file.find(200000), file.end());
+  EXPECT_EQ(file.lower_bound(-1), file.begin());
+  EXPECT_EQ(file.lower_bound(199999), file.end());
+  EXPECT_EQ(std::get<int>((*file.lower_bound(101)).get_field(0)), 102);
+  EXPECT_EQ(std::get<int>((*file.upper_bound(102)).get_field(0)), 104);
+}
+
+TEST(BTreeTest, MultiGet) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  EXPECT_TRUE(file.multiGet(std::vector<int>{1, 2}).empty());
+  for (int i = 0; i < 100000; i++) {
+    int k = i % 2 ? 100000 - i : i;
+    file.insertTuple({{k * 2, "apple", 1.0}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  // Unsorted probes with duplicates and missing keys
+  std::vector<int> keys;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> dis(-10, 200010);
+  for (int i = 0; i < 5000; i++) {
+    keys.push_back(dis(gen));
+  }
+  keys.push_back(keys.front());
+  std::set<int> expected;
+  for (int k : keys) {
+    if (k >= 0 && k < 200000 && k % 2 == 0) {
+      expected.insert(k);
+    }
+  }
+  size_t reads = file.getReads().size();
+  auto tuples = file.multiGet(keys);
+  // Every page is read at most once
+  EXPECT_LE(file.getReads().size() - reads, file.getNumPages());
+  ASSERT_EQ(tuples.size(), expected.size());
+  auto it = expected.begin();
+  for (const auto &t : tuples) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), *it++);
+  }
+
+  // Every tuple of a duplicate key, across leaves
+  const char *dup_name = "index.db";
+  std::remove(dup_name);
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(dup_name, td, 0, false));
+  auto &dups = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(dup_name));
+  for (int i = 0; i < 20000; i++) {
+    dups.insertTuple({{i % 100, "apple", 1.0}});
+  }
+  tuples = dups.multiGet(std::vector<int>{99, 7, 50, 7, 100});
+  ASSERT_EQ(tuples.size(), 600);
+  for (size_t i = 0; i < tuples.size(); i++) {
+    EXPECT_EQ(std::get<int>(tuples[i].get_field(0)), i < 200 ? 7 : i < 400 ? 50 : 99);
+  }
+}
+
+TEST(BTreeTest, BloomFilter) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  EXPECT_FALSE(file.getBloomStats().has_value());
+  for (int i = 0; i < 1000; i++) {
+    file.insertTuple({{i * 2, "apple", 1.0}});
+  }
+  // Keys inserted before and after the filter is enabled, growing it past its size
+  file.enableBloomFilter();
+  for (int i = 1000; i < 20000; i++) {
+    file.insertTuple({{i * 2, "apple", 1.0}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  auto missing = [&](db::BTreeFile &f) {
+    size_t reads = f.getReads().size();
+    for (int i = 0; i < 10000; i++) {
+      EXPECT_FALSE(f.lookup(i * 2 + 1).has_value());
+    }
+    return f.getReads().size() - reads;
+  };
+  EXPECT_LT(missing(file), 1000);
+  auto stats = *file.getBloomStats();
+  EXPECT_EQ(stats.probes, 10000);
+  EXPECT_GT(stats.negatives, 9500);
+  EXPECT_EQ(stats.negatives + stats.false_positives, stats.probes);
+  for (int i = 0; i < 20000; i += 7) {
+    EXPECT_TRUE(file.lookup(i * 2).has_value());
+  }
+  EXPECT_EQ(file.multiGet(std::vector<int>{1, 2, 3, 4, 39998, 39999}).size(), 3);
+
+  // The filter is written next to the file and read back
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+  db::getDatabase().remove(name);
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &reopened = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  ASSERT_TRUE(reopened.getBloomStats().has_value());
+  EXPECT_LT(missing(reopened), 1000);
+  EXPECT_TRUE(reopened.lookup(39998).has_value());
+
+  // A file whose pages reach disk without being destroyed (a crash) is opened without the filter, which lacks the key
+  reopened.insertTuple({{1, "apple", 1.0}});
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::BTreeFile crashed(name, td, 0);
+  EXPECT_FALSE(crashed.getBloomStats().has_value());
+  EXPECT_TRUE(crashed.lookup(1).has_value());
+}
+
+TEST(BTreeTest, Range) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  for (int i = 0; i < 100000; i++) {
+    db::Tuple t{{i, "apple", 1.0}};
+    file.insertTuple(t);
+  }
+
+  int i = 5000;
+  for (const auto &t : file.range(5000, 7500)) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, 7500);
+  EXPECT_EQ(file.range(10, 10).begin(), file.range(10, 10).end());
+}
+
+TEST(BTreeTest, Filter) {
+  const char *name = "test.db";
+  const char *out_name = "test.out";
+  std::remove(name);
+  std::remove(out_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td));
+  auto &file = db::getDatabase().get(name);
+  auto &out = db::getDatabase().get(out_name);
+  for (int i = 0; i < 100000; i++) {
+    db::Tuple t{{i, "apple", i % 2 ? 1.0 : 2.0}};
+    file.insertTuple(t);
+  }
+
+  size_t reads = file.getReads().size();
+  db::filter(file, out, {{"id", db::PredicateOp::GT, 500}, {"id", db::PredicateOp::LE, 1000}, {"price", db::PredicateOp::EQ, 2.0}});
+  EXPECT_LT(file.getReads().size() - reads, 50);
+  int i = 502;
+  for (const auto &t : out) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i += 2;
+  }
+  EXPECT_EQ(i, 1002);
+}
+
+TEST(BTreeTest, BulkLoad) {
+  const char *name = "test.db";
+  const char *in_name = "test.in";
+  std::remove(name);
+  std::remove(in_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(in_name, td));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  auto &in = db::getDatabase().get(in_name);
+  for (int i = 0; i < 100000; i++) {
+    in.insertTuple({{i * 2, "apple", 1.0}});
+  }
+
+  size_t writes = file.getWrites().size();
+  file.bulkLoad(in);
+  const auto &w = file.getWrites();
+  for (size_t i = writes + 1; i + 1 < w.size(); i++) {
+    EXPECT_EQ(w[i], w[i - 1] + 1);
+  }
+  // 100000 tuples in leaves of 48, one index level below the root
+  EXPECT_EQ(file.getNumPages(), 1 + (100000 + 47) / 48 + 7);
+  EXPECT_THROW(file.bulkLoad(in), std::logic_error);
+
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i * 2);
+    i++;
+  }
+  EXPECT_EQ(i, 100000);
+  for (int k = 1; k < 200000; k += 20) {
+    file.insertTuple({{k, "apple", 1.0}});
+  }
+  EXPECT_NE(file.find(199981), file.end());
+  EXPECT_NE(file.find(199998), file.end());
+  EXPECT_EQ(file.find(199997), file.end());
+  int prev = -1;
+  i = 0;
+  for (const auto &t : file) {
+    EXPECT_LT(prev, std::get<int>(t.get_field(0)));
+    prev = std::get<int>(t.get_field(0));
+    i++;
+  }
+  EXPECT_EQ(i, 110000);
+}
+
+TEST(BTreeTest, BulkLoadUnsorted) {
+  const char *name = "test.db";
+  const char *in_name = "test.in";
+  std::remove(name);
+  std::remove(in_name);
+  db::TupleDesc td({db::type_t::CHAR, db::type_t::INT, db::type_t::DOUBLE}, {"name", "id", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 1));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(in_name, td));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  auto &in = db::getDatabase().get(in_name);
+  for (int i = 0; i < 50000; i++) {
+    in.insertTuple({{"apple", (i * 7919) % 50000, 1.0}});
+  }
+  in.insertTuple({{"orange", 42, 2.0}});
+
+  file.bulkLoad(in, 0.5);
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(1)), i);
+    EXPECT_EQ(std::get<std::string>(t.get_field(0)), i == 42 ? "orange" : "apple");
+    i++;
+  }
+  EXPECT_EQ(i, 50000);
+  // leaves of 24 tuples, index pages of 170 children
+  EXPECT_EQ(file.getNumPages(), 1 + (50000 + 23) / 24 + 13);
+}
+
+TEST(BTreeTest, LearnedIndex) {
+  const char *name = "test.db";
+  const char *in_name = "test.in";
+  std::remove(name);
+  std::remove(in_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(in_name, td));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  auto &in = db::getDatabase().get(in_name);
+  // Clusters of consecutive keys separated by gaps of growing size
+  std::vector<int> keys;
+  for (int c = 0; c < 200; c++) {
+    for (int i = 0; i < 300; i++) {
+      keys.push_back(c * c * 1000 + i);
+    }
+  }
+  for (int k : keys) {
+    in.insertTuple({{k, "apple", 1.0}});
+  }
+  file.enableLearnedIndex(8);
+  EXPECT_EQ(file.getLearnedIndex(), nullptr);
+  file.bulkLoad(in);
+  ASSERT_NE(file.getLearnedIndex(), nullptr);
+  EXPECT_LT(file.getLearnedIndex()->getSegments(), 1000);
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  // A lookup reads the predicted leaf, and the next one if the window crosses it, but no index page
+  size_t reads = file.getReads().size();
+  for (size_t i = 0; i < keys.size(); i += 97) {
+    ASSERT_TRUE(file.lookup(keys[i]).has_value()) << keys[i];
+    EXPECT_EQ(std::get<int>(file.lookup(keys[i])->get_field(0)), keys[i]);
+  }
+  // The leaves are the pages after the root, in leaves of 48
+  for (size_t r : std::span(file.getReads()).subspan(reads)) {
+    EXPECT_GE(r, 1);
+    EXPECT_LE(r, (keys.size() + 47) / 48);
+  }
+  EXPECT_FALSE(file.lookup(-1).has_value());
+  EXPECT_FALSE(file.lookup(1000 + 300).has_value());
+  EXPECT_EQ(file.find(199 * 199 * 1000 + 300), file.end());
+  EXPECT_EQ(std::get<int>((*file.lower_bound(5 * 5 * 1000 + 300)).get_field(0)), 6 * 6 * 1000);
+  EXPECT_EQ(std::get<int>((*file.lower_bound(-5)).get_field(0)), 0);
+  EXPECT_EQ(file.lower_bound(199 * 199 * 1000 + 300), file.end());
+  EXPECT_THROW(file.insertTuple({{1, "apple", 1.0}}), std::logic_error);
+
+  // The model is rebuilt from the leaves of a reopened file
+  db::getDatabase().remove(name);
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &reopened = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  reopened.enableLearnedIndex(8);
+  ASSERT_NE(reopened.getLearnedIndex(), nullptr);
+  for (size_t i = 0; i < keys.size(); i += 101) {
+    EXPECT_TRUE(reopened.lookup(keys[i]).has_value());
+  }
+
+  // With duplicate keys, the first tuple of a key is found even after a long run of the previous key
+  const char *dup_name = "index.db";
+  std::remove(dup_name);
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(dup_name, td, 0, false));
+  auto &dups = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(dup_name));
+  const char *dup_in_name = "test.dup";
+  std::remove(dup_in_name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(dup_in_name, td));
+  auto &dup_in = db::getDatabase().get(dup_in_name);
+  for (int i = 0; i < 20000; i++) {
+    dup_in.insertTuple({{i < 10000 ? i / 100 : i, "apple", 1.0}});
+  }
+  dups.enableLearnedIndex(4);
+  dups.bulkLoad(dup_in);
+  for (int k : {0, 7, 99, 10000, 15000}) {
+    auto it = dups.find(k);
+    ASSERT_NE(it, dups.end());
+    size_t count = 0;
+    for (; it != dups.end() && std::get<int>((*it).get_field(0)) == k; ++it) {
+      count++;
+    }
+    EXPECT_EQ(count, k < 100 ? 100 : 1);
+  }
+  EXPECT_EQ(std::get<int>((*dups.lower_bound(100)).get_field(0)), 10000);
+}
+
+TEST(BTreeTest, Concurrent) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  constexpr int n = 200000;
+  constexpr int writers = 4;
+  std::atomic<int> inserted[writers]{};
+  std::atomic<bool> done{false};
+  std::atomic<int> missing{0};
+
+  // Writer w inserts the keys k with k % writers == w, in an order that splits pages all over the tree
+  std::vector<std::thread> threads;
+  for (int w = 0; w < writers; ++w) {
+    threads.emplace_back([&, w] {
+      for (int i = 0; i < n / writers; ++i) {
+        int j = i % 2 ? n / writers - i : i;
+        file.insertTuple({{j * writers + w, "apple", 1.0}});
+        inserted[w] = i + 1;
+      }
+    });
+  }
+  // Readers look up keys that were already inserted; every one of them must be found
+  for (int r = 0; r < 2; ++r) {
+    threads.emplace_back([&, r] {
+      for (unsigned i = r; !done; i += 7919) {
+        int w = i % writers;
+        int count = inserted[w];
+        if (count == 0) {
+          continue;
+        }
+        int k = (i / writers) % count;
+        int j = k % 2 ? n / writers - k : k;
+        auto t = file.lookup(j * writers + w);
+        if (!t || std::get<int>(t->get_field(0)) != j * writers + w) {
+          missing++;
+        }
+      }
+    });
+  }
+  for (int w = 0; w < writers; ++w) {
+    threads[w].join();
+  }
+  done = true;
+  for (size_t t = writers; t < threads.size(); ++t) {
+    threads[t].join();
+  }
+
+  EXPECT_EQ(missing, 0);
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, n);
+}
+
+TEST(BTreeTest, Append) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  for (int i = 0; i < 100000; i++) {
+    file.insertTuple({{i * 2, "apple", 1.0}});
+  }
+  // Appends leave 44 of the 49 tuples in each leaf instead of 24
+  EXPECT_LE(file.getNumPages(), 1 + (100000 + 43) / 44 + 8);
+
+  // Keys in the middle of the tree still split in half
+  for (int i = 0; i < 1000; i++) {
+    file.insertTuple({{i * 200 + 1, "orange", 2.0}});
+  }
+  int i = 0;
+  int prev = -1;
+  for (const auto &t : file) {
+    EXPECT_LT(prev, std::get<int>(t.get_field(0)));
+    prev = std::get<int>(t.get_field(0));
+    i++;
+  }
+  EXPECT_EQ(i, 101000);
+  for (int k = 0; k < 200000; k += 998) {
+    EXPECT_EQ(std::get<int>(file.lookup(k)->get_field(0)), k);
+  }
+  EXPECT_EQ(std::get<std::string>(file.lookup(201)->get_field(1)), "orange");
+}
+
+TEST(BTreeTest, Delete) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  constexpr int n = 100000;
+  for (int i = 0; i < n; i++) {
+    int k = i % 2 ? n - i : i;
+    file.insertTuple({{k, "apple", 1.0}});
+  }
+  size_t pages = file.getNumPages();
+  auto leaves = [&] {
+    std::set<size_t> ids;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+      ids.insert(it.page);
+    }
+    return ids.size();
+  };
+  size_t full = leaves();
+
+  // Delete 3 out of every 4 keys
+  for (int k = 0; k < n; k++) {
+    if (k % 4) {
+      file.deleteTuple(file.find(k));
+    }
+  }
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i * 4);
+    i++;
+  }
+  EXPECT_EQ(i, n / 4);
+  EXPECT_LE(leaves(), full / 2);
+  for (int k = 0; k < n; k += 97) {
+    EXPECT_EQ(file.find(k) == file.end(), k % 4 != 0);
+  }
+
+  // Delete the rest, then insert again: the freed pages are reused
+  for (int k = 0; k < n; k += 4) {
+    file.deleteTuple(file.find(k));
+  }
+  EXPECT_EQ(file.begin(), file.end());
+  for (int i = 0; i < n; i++) {
+    int k = i % 2 ? n - i : i;
+    file.insertTuple({{k, "apple", 1.0}});
+  }
+  EXPECT_EQ(file.getNumPages(), pages);
+  i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, n);
+}
+
+TEST(BTreeTest, CompositeKey) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::NormalizedKey key(td, {1, 2});
+  db::getDatabase().add(std::make_unique<db::BasicBTreeFile<db::NormalizedKey>>(name, td, key));
+  auto &file = dynamic_cast<db::BasicBTreeFile<db::NormalizedKey> &>(db::getDatabase().get(name));
+  // Names of different lengths and negative prices check the byte order of the normalized keys
+  std::vector<std::string> names{"", "a", "ab", "b", "banana", "cherry"};
+  constexpr int n = 20000;
+  for (int i = 0; i < n; i++) {
+    int k = i % 2 ? n - i : i;
+    file.insertTuple({{k, names[k % names.size()], (k / names.size()) - n / 2.0}});
+  }
+
+  int i = 0;
+  std::optional<std::pair<std::string, double>> prev;
+  for (const auto &t : file) {
+    std::pair<std::string, double> cur{std::get<std::string>(t.get_field(1)), std::get<double>(t.get_field(2))};
+    if (prev) {
+      EXPECT_LT(*prev, cur);
+    }
+    prev = cur;
+    i++;
+  }
+  EXPECT_EQ(i, n);
+
+  auto it = file.find(key.encode({"banana", 7.0 - n / 2.0}));
+  ASSERT_NE(it, file.end());
+  EXPECT_EQ(std::get<int>(file.getTuple(it).get_field(0)), 7 * 6 + 4);
+  EXPECT_EQ(file.find(key.encode({"bananas", 7.0 - n / 2.0})), file.end());
+  auto next = file.lower_bound(key.encode({"b", 1e9}));
+  EXPECT_EQ(std::get<std::string>(file.getTuple(next).get_field(1)), "banana");
+  EXPECT_THROW(key.encode({"b"}), std::logic_error);
+  EXPECT_THROW(key.encode({1, 2.0}), std::logic_error);
+
+  for (int k = 0; k < n; k += 2) {
+    file.deleteTuple(file.find(key.extract({{k, names[k % names.size()], (k / names.size()) - n / 2.0}})));
+  }
+  i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)) % 2, 1);
+    i++;
+  }
+  EXPECT_EQ(i, n / 2);
+}
+
+TEST(BTreeTest, DoubleKeyBulkLoad) {
+  const char *name = "test.db";
+  const char *heap_name = "heap.db";
+  std::remove(name);
+  std::remove(heap_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, td));
+  auto &heap = db::getDatabase().get(heap_name);
+  constexpr int n = 10000;
+  for (int i = 0; i < n; i++) {
+    int k = i * 7919 % n;
+    heap.insertTuple({{k, (k - n / 2) * 0.5}});
+  }
+  db::NormalizedKey key(td, {1});
+  db::getDatabase().add(std::make_unique<db::BasicBTreeFile<db::NormalizedKey>>(name, td, key));
+  auto &file = dynamic_cast<db::BasicBTreeFile<db::NormalizedKey> &>(db::getDatabase().get(name));
+  file.bulkLoad(heap);
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, n);
+  auto range = file.range(key.encode({-1.0}), key.encode({1.0}));
+  i = 0;
+  for (auto it = range.first; it != range.last; ++it) {
+    i++;
+  }
+  EXPECT_EQ(i, 4);
+  db::getDatabase().remove(heap_name);
+}
@@ -0,0 +1,102 @@
+#include <db/Database.hpp>
+#include <db/HashFile.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Query.hpp>
+#include <gtest/gtest.h>
+#include <set>
+
+TEST(HashTest, Insert) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 0));
+  auto &file = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(file.begin(), file.end());
+  EXPECT_EQ(file.find(1), file.end());
+  for (int i = 0; i < 50000; i++) {
+    file.insertTuple({{i * 7, "apple", 1.0}});
+  }
+  // Replacing a key keeps a single tuple
+  file.insertTuple({{7, "banana", 2.0}});
+  EXPECT_GT(file.getGlobalDepth(), 0);
+
+  std::set<int> keys;
+  for (const auto &t : file) {
+    EXPECT_TRUE(keys.insert(std::get<int>(t.get_field(0))).second);
+  }
+  EXPECT_EQ(keys.size(), 50000);
+
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+  for (int k = 0; k < 350000; k += 997) {
+    size_t reads = file.getReads().size();
+    auto it = file.find(k);
+    // The header, a directory page and the bucket
+    EXPECT_LE(file.getReads().size() - reads, 3);
+    if (k % 7) {
+      EXPECT_EQ(it, file.end());
+    } else {
+      ASSERT_NE(it, file.end());
+      EXPECT_EQ((*it).get_field(0), db::field_t{k});
+    }
+  }
+  EXPECT_EQ(std::get<std::string>((*file.find(7)).get_field(1)), "banana");
+}
+
+TEST(HashTest, Duplicates) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::CHAR, db::type_t::INT}, {"name", "id"});
+  db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 0, false));
+  auto &file = dynamic_cast<db::HashFile &>(db::getDatabase().get(name));
+  // Too many copies of a key for one page, which need overflow pages instead of splits
+  for (int i = 0; i < 3000; i++) {
+    file.insertTuple({{i % 3 ? "apple" : std::to_string(i), i}});
+  }
+  EXPECT_EQ(file.findAll("apple").size(), 2000);
+  EXPECT_EQ(file.findAll("3").size(), 1);
+  EXPECT_TRUE(file.findAll("4").empty());
+
+  // Deleting every copy frees the overflow pages, which inserting them again reuses
+  while (file.find("apple") != file.end()) {
+    file.deleteTuple(file.find("apple"));
+  }
+  EXPECT_TRUE(file.findAll("apple").empty());
+  size_t pages = file.getNumPages();
+  for (int i = 0; i < 2000; i++) {
+    file.insertTuple({{"apple", i}});
+  }
+  EXPECT_EQ(file.getNumPages(), pages);
+  int count = 0;
+  for (const auto &t : file) {
+    count++;
+  }
+  EXPECT_EQ(count, 3000);
+}
+
+TEST(HashTest, Filter) {
+  const char *name = "test.db";
+  const char *out_name = "out.db";
+  std::remove(name);
+  std::remove(out_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HashFile>(name, td, 2, false));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td));
+  auto &file = db::getDatabase().get(name);
+  auto &out = db::getDatabase().get(out_name);
+  for (int i = 0; i < 20000; i++) {
+    file.insertTuple({{i, "apple", i % 1000}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  size_t reads = file.getReads().size();
+  db::filter(file, out, {{"price", db::PredicateOp::EQ, 42}, {"id", db::PredicateOp::LT, 10000}});
+  EXPECT_LE(file.getReads().size() - reads, 3);
+  std::set<int> ids;
+  for (const auto &t : out) {
+    EXPECT_EQ(std::get<int>(t.get_field(2)), 42);
+    ids.insert(std::get<int>(t.get_field(0)));
+  }
+  EXPECT_EQ(ids, std::set<int>({42, 1042, 2042, 3042, 4042, 5042, 6042, 7042, 8042, 9042}));
+}
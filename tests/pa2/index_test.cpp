@@ -6,7 +6,7 @@ TEST(IndexTest, InsertFirst) {
   db::IndexPage index{page};
   int capacity = index.capacity;
   EXPECT_EQ(sizeof(size_t), 8);
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, 338);
 
   for (int i = 1; i < capacity; i++) {
     EXPECT_FALSE(index.insert(i * 2, 1000 + i));
@@ -22,7 +22,7 @@ TEST(IndexTest, InsertLast) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, 338);
 
   for (int i = 1; i < capacity; i++) {
     EXPECT_FALSE(index.insert(i * 2, 1000 + i));
@@ -38,7 +38,7 @@ TEST(IndexTest, InsertMiddle) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, 338);
 
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
@@ -58,7 +58,7 @@ TEST(IndexTest, Split) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, 338);
 
   for (int i = 0; i < capacity - 1; i++) {
     db::Tuple t{{i * 2, "apple", 1.0}};
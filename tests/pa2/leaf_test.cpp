@@ -6,7 +6,7 @@ TEST(LeafTest, InsertFirst) {
   db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
   db::LeafPage leaf{page, td, 0};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, 49);
   std::vector<int> ids;
   ids.push_back(0);
   for (int i = 1; i < capacity; i++) {
@@ -28,7 +28,7 @@ TEST(LeafTest, InsertLast) {
   db::TupleDesc td({db::type_t::CHAR, db::type_t::INT, db::type_t::DOUBLE}, {"name", "id", "price"});
   db::LeafPage leaf{page, td, 1};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, 49);
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
     ids.push_back(i * 2);
@@ -50,7 +50,7 @@ TEST(LeafTest, InsertMiddle) {
   db::TupleDesc td({db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::INT}, {"name", "price", "id"});
   db::LeafPage leaf{page, td, 2};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, 49);
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
     ids.push_back(i * 2);
@@ -73,7 +73,7 @@ TEST(LeafTest, Update) {
   db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
   db::LeafPage leaf{page, td, 0};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, 49);
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
     ids.push_back(i * 2);
@@ -109,7 +109,7 @@ TEST(LeafTest, Split) {
   const size_t rand_leaf = rand();
   leaf.header->next_leaf = rand_leaf;
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, 49);
   for (int i = 0; i < capacity - 1; i++) {
     db::Tuple t{{i * 2, "apple", 1.0}};
     EXPECT_FALSE(leaf.insertTuple(t));
@@ -131,3 +131,33 @@ TEST(LeafTest, Split) {
     EXPECT_EQ(t.get_field(0), db::field_t{(leaf.header->size + i) * 2});
   }
 }
+
+TEST(LeafTest, SplitReversed) {
+  db::Page page{};
+  db::TupleDesc td({db::type_t::CHAR, db::type_t::INT}, {"name", "id"});
+  db::LeafPage leaf{page, td, 1};
+  int capacity = leaf.capacity;
+  for (int i = capacity - 1; i > 0; i--) {
+    EXPECT_FALSE(leaf.insertTuple({{std::to_string(i), i}}));
+  }
+  EXPECT_TRUE(leaf.insertTuple({{std::to_string(0), 0}}));
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_EQ(leaf.keys[i], i);
+  }
+
+  db::Page new_page{};
+  db::LeafPage new_leaf{new_page, td, 1};
+  int key = leaf.split(new_leaf);
+  EXPECT_EQ(key, capacity / 2);
+  for (int i = 0; i < leaf.header->size; i++) {
+    EXPECT_LT(leaf.slots[i], leaf.header->size);
+    db::Tuple t = leaf.getTuple(i);
+    EXPECT_EQ(t.get_field(1), db::field_t{i});
+    EXPECT_EQ(t.get_field(0), db::field_t{std::to_string(i)});
+  }
+  for (int i = 0; i < new_leaf.header->size; i++) {
+    db::Tuple t = new_leaf.getTuple(i);
+    EXPECT_EQ(t.get_field(1), db::field_t{key + i});
+    EXPECT_EQ(t.get_field(0), db::field_t{std::to_string(key + i)});
+  }
+}
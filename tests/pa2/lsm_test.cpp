@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <db/Database.hpp>
+#include <db/LSMFile.hpp>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+
+TEST(LSMTest, Insert) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::LSMFile>(name, td, 0, 2));
+  auto &file = dynamic_cast<db::LSMFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(file.begin(), file.end());
+  std::vector<int> keys(20000);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  for (int k : keys) {
+    file.insertTuple({{k, "apple", 1.0}});
+  }
+  // Newer tuples replace older ones, and deleted keys are skipped
+  for (int k = 0; k < 20000; k += 3) {
+    file.insertTuple({{k, "banana", 2.0}});
+  }
+  for (auto it = file.begin(); it != file.end(); ++it) {
+    if (std::get<int>((*it).get_field(0)) % 5 == 0) {
+      file.deleteTuple(it);
+    }
+  }
+  EXPECT_GT(file.getRuns().size(), 1);
+  EXPECT_LE(file.getRuns().size(), db::LSMFile::L0_RUNS + 2);
+
+  int expected = 1;
+  for (const auto &t : file) {
+    int k = std::get<int>(t.get_field(0));
+    ASSERT_EQ(k, expected);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), k % 3 ? "apple" : "banana");
+    expected += expected % 5 == 4 ? 2 : 1;
+  }
+  EXPECT_EQ(expected, 20001);
+  EXPECT_FALSE(file.lookup(10).has_value());
+  EXPECT_FALSE(file.lookup(-1).has_value());
+  EXPECT_EQ(std::get<std::string>(file.lookup(9)->get_field(1)), "banana");
+  EXPECT_EQ(std::get<std::string>(file.lookup(11)->get_field(1)), "apple");
+}
+
+TEST(LSMTest, SequentialWrites) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::LSMFile>(name, td, 0, 4));
+  auto &file = dynamic_cast<db::LSMFile &>(db::getDatabase().get(name));
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<> dis(0, 1000000);
+  for (int i = 0; i < 50000; i++) {
+    file.insertTuple({{dis(gen), "apple", 1.0}});
+  }
+  file.flush();
+  // Apart from the first page, runs are written one page after the other
+  const auto &writes = file.getWrites();
+  size_t sequential = 0;
+  size_t total = 0;
+  for (size_t i = 1; i < writes.size(); i++) {
+    if (writes[i] != 0) {
+      total++;
+      sequential += writes[i] == writes[i - 1] + 1;
+    }
+  }
+  EXPECT_GT(sequential, total * 9 / 10);
+
+  // The runs are read back from the first page
+  std::vector<db::field_t> fields;
+  for (const auto &t : file) {
+    fields.push_back(t.get_field(0));
+  }
+  db::getDatabase().getBufferPool().discardFile(name);
+  db::getDatabase().remove(name);
+  db::getDatabase().add(std::make_unique<db::LSMFile>(name, td, 0, 4));
+  auto &reopened = dynamic_cast<db::LSMFile &>(db::getDatabase().get(name));
+  std::vector<db::field_t> reopened_fields;
+  for (const auto &t : reopened) {
+    reopened_fields.push_back(t.get_field(0));
+  }
+  EXPECT_EQ(reopened_fields, fields);
+}
+
+TEST(LSMTest, BloomFilter) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::LSMFile>(name, td, 0, 2));
+  auto &file = dynamic_cast<db::LSMFile &>(db::getDatabase().get(name));
+  for (int i = 0; i < 20000; i++) {
+    file.insertTuple({{i * 2, "apple", 1.0}});
+  }
+  file.flush();
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  // Missing keys within the range of every run are ruled out without reading the runs
+  auto missing = [&](db::LSMFile &f) {
+    size_t reads = f.getReads().size();
+    for (int i = 0; i < 10000; i++) {
+      EXPECT_FALSE(f.lookup(i * 4 + 1).has_value());
+    }
+    return f.getReads().size() - reads;
+  };
+  EXPECT_LT(missing(file), 1000);
+  db::BloomStats stats = file.getBloomStats();
+  EXPECT_GT(stats.negatives, stats.probes * 9 / 10);
+  EXPECT_EQ(stats.negatives + stats.false_positives, stats.probes);
+  EXPECT_TRUE(file.lookup(39998).has_value());
+
+  // The filters are stored after the runs
+  db::getDatabase().getBufferPool().discardFile(name);
+  db::getDatabase().remove(name);
+  db::getDatabase().add(std::make_unique<db::LSMFile>(name, td, 0, 2));
+  auto &reopened = dynamic_cast<db::LSMFile &>(db::getDatabase().get(name));
+  EXPECT_LT(missing(reopened), 1000);
+  EXPECT_GT(reopened.getBloomStats().negatives, 0);
+  for (int i = 0; i < 20000; i += 7) {
+    EXPECT_TRUE(reopened.lookup(i * 2).has_value());
+  }
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <climits>
+#include <db/KeySearch.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(SearchTest, Dense) {
+  std::mt19937 gen(660);
+  std::uniform_int_distribution<> dis(-1000, 1000);
+  for (size_t n = 0; n < 400; n++) {
+    std::vector<int> keys(n);
+    for (auto &k : keys) {
+      k = dis(gen);
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<int> probes{INT_MIN, INT_MAX, -1001, 1001};
+    for (int i = 0; i < 50; i++) {
+      probes.push_back(dis(gen));
+    }
+    for (int key : probes) {
+      auto lower = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+      auto upper = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+      EXPECT_EQ(db::search::lower_bound(keys.data(), n, key), lower);
+      EXPECT_EQ(db::search::upper_bound(keys.data(), n, key), upper);
+    }
+  }
+}
+
+TEST(SearchTest, Strided) {
+  struct Row {
+    double price;
+    int key;
+    char name[20];
+  };
+  std::mt19937 gen(660);
+  std::uniform_int_distribution<> dis(INT_MIN, INT_MAX);
+  for (size_t n = 0; n < 100; n++) {
+    std::vector<int> keys(n);
+    for (auto &k : keys) {
+      k = dis(gen);
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<Row> rows(n);
+    for (size_t i = 0; i < n; i++) {
+      rows[i].key = keys[i];
+    }
+    const auto *base = reinterpret_cast<const uint8_t *>(rows.data()) + offsetof(Row, key);
+    std::vector<int> probes{INT_MIN, INT_MAX};
+    for (int i = 0; i < 20; i++) {
+      probes.push_back(dis(gen));
+    }
+    probes.insert(probes.end(), keys.begin(), keys.end());
+    for (int key : probes) {
+      auto lower = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+      auto upper = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+      EXPECT_EQ(db::search::lower_bound(base, sizeof(Row), n, key), lower);
+      EXPECT_EQ(db::search::upper_bound(base, sizeof(Row), n, key), upper);
+    }
+  }
+}
@@ -0,0 +1,202 @@
+#include <db/BTreeIndex.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Query.hpp>
+#include <gtest/gtest.h>
+
+TEST(SecondaryTest, Duplicates) {
+  const char *name = "index.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0, false));
+  auto &file = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(name));
+  // 200 copies of each of 100 keys spread over many leaves
+  for (int i = 0; i < 20000; i++) {
+    file.insertTuple({{i % 100, std::to_string(i)}});
+  }
+  for (int k : {0, 1, 50, 99}) {
+    int count = 0;
+    for (auto it = file.find(k); it != file.end() && std::get<int>((*it).get_field(0)) == k; ++it) {
+      count++;
+    }
+    EXPECT_EQ(count, 200);
+  }
+  int count = 0;
+  for (const auto &t : file.range(20, 30)) {
+    EXPECT_GE(std::get<int>(t.get_field(0)), 20);
+    EXPECT_LT(std::get<int>(t.get_field(0)), 30);
+    count++;
+  }
+  EXPECT_EQ(count, 2000);
+
+  // Delete every copy of a key, one at a time from the middle
+  for (int i = 0; i < 200; i++) {
+    auto it = file.find(50);
+    for (int j = 0; j < (199 - i) / 2; j++) {
+      ++it;
+    }
+    file.deleteTuple(it);
+  }
+  EXPECT_EQ(file.find(50), file.end());
+  EXPECT_EQ(std::get<int>((*file.lower_bound(50)).get_field(0)), 51);
+}
+
+TEST(SecondaryTest, Index) {
+  const char *name = "test.db";
+  const char *index_name = "index.db";
+  std::remove(name);
+  std::remove(index_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  db::getDatabase().add(std::make_unique<db::BTreeIndex>(index_name, 2));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  auto &index = dynamic_cast<db::BTreeIndex &>(db::getDatabase().get(index_name));
+  for (int i = 0; i < 5000; i++) {
+    file.insertTuple({{i, "apple", i % 100}});
+  }
+  // Existing tuples are indexed when the index is added, later ones on insert
+  file.addIndex(index);
+  EXPECT_EQ(file.getIndex(2), &index);
+  EXPECT_EQ(file.getIndex(0), nullptr);
+  for (int i = 5000; i < 10000; i++) {
+    file.insertTuple({{i, "apple", i % 100}});
+  }
+
+  auto rids = index.rids(file, 42, 43);
+  ASSERT_EQ(rids.size(), 200);
+  for (size_t i = 0; i < rids.size(); i++) {
+    int price = std::get<int>(file.getTuple(rids[i]).get_field(2));
+    EXPECT_TRUE(price == 42 || price == 43);
+    if (i > 0) {
+      EXPECT_TRUE(rids[i - 1].page < rids[i].page ||
+                  (rids[i - 1].page == rids[i].page && rids[i - 1].slot < rids[i].slot));
+    }
+  }
+
+  // Deleting a tuple removes its record id
+  file.deleteTuple(rids[0]);
+  EXPECT_EQ(index.rids(file, 42, 43).size(), 199);
+  EXPECT_THROW(index.deleteEntry(42, rids[0].page, rids[0].slot), std::logic_error);
+}
+
+TEST(SecondaryTest, Filter) {
+  const char *name = "test.db";
+  const char *index_name = "index.db";
+  const char *out_name = "out.db";
+  std::remove(name);
+  std::remove(index_name);
+  std::remove(out_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  db::getDatabase().add(std::make_unique<db::BTreeIndex>(index_name, 2));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  file.addIndex(dynamic_cast<db::BTreeIndex &>(db::getDatabase().get(index_name)));
+  auto &out = db::getDatabase().get(out_name);
+  for (int i = 0; i < 100000; i++) {
+    file.insertTuple({{i, "apple", i}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  size_t reads = file.getReads().size();
+  db::filter(file, out, {{"price", db::PredicateOp::GE, 5000}, {"price", db::PredicateOp::LT, 5100}});
+  // Only the pages that hold the 100 tuples are read
+  EXPECT_LE(file.getReads().size() - reads, 3);
+  int i = 5000;
+  for (const auto &t : out) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, 5100);
+}
+
+TEST(SecondaryTest, Covering) {
+  const char *name = "test.db";
+  const char *index_name = "index.db";
+  const char *out_name = "out.db";
+  const char *agg_name = "agg.db";
+  std::remove(name);
+  std::remove(index_name);
+  std::remove(out_name);
+  std::remove(agg_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::INT, db::type_t::DOUBLE},
+                   {"id", "name", "price", "qty"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  db::getDatabase().add(std::make_unique<db::BTreeIndex>(index_name, td, 2, std::vector<size_t>{3}));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(
+      out_name, db::TupleDesc({db::type_t::DOUBLE, db::type_t::INT}, {"qty", "price"})));
+  db::getDatabase().add(
+      std::make_unique<db::HeapFile>(agg_name, db::TupleDesc({db::type_t::INT, db::type_t::DOUBLE}, {"price", "sum"})));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  auto &index = dynamic_cast<db::BTreeIndex &>(db::getDatabase().get(index_name));
+  file.addIndex(index);
+  auto &out = db::getDatabase().get(out_name);
+  auto &agg = db::getDatabase().get(agg_name);
+  for (int i = 0; i < 10000; i++) {
+    file.insertTuple({{i, "apple", 99 - i % 100, 0.5}});
+  }
+  EXPECT_TRUE(index.covers({2, 3}));
+  EXPECT_FALSE(index.covers({0, 2}));
+  EXPECT_EQ(file.getCoveringIndex({3}), &index);
+  EXPECT_EQ(file.getCoveringIndex({1}), nullptr);
+  db::getDatabase().getBufferPool().flushFile(name);
+  db::getDatabase().getBufferPool().discardFile(name);
+
+  // Both queries only read the index, which returns the tuples in key order
+  size_t reads = file.getReads().size();
+  db::projection(file, out, {"qty", "price"});
+  db::aggregate(file, agg, {"price", db::AggregateOp::SUM, "qty"});
+  EXPECT_EQ(file.getReads().size(), reads);
+  int i = 0;
+  for (const auto &t : out) {
+    EXPECT_EQ(std::get<double>(t.get_field(0)), 0.5);
+    EXPECT_EQ(std::get<int>(t.get_field(1)), i / 100);
+    i++;
+  }
+  EXPECT_EQ(i, 10000);
+  i = 0;
+  for (const auto &t : agg) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    EXPECT_EQ(std::get<double>(t.get_field(1)), 50.0);
+    i++;
+  }
+  EXPECT_EQ(i, 100);
+}
+
+TEST(SecondaryTest, DeleteDuplicates) {
+  const char *name = "test.db";
+  const char *index_name = "index.db";
+  std::remove(name);
+  std::remove(index_name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  db::getDatabase().add(std::make_unique<db::BTreeIndex>(index_name, 2));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  auto &index = dynamic_cast<db::BTreeIndex &>(db::getDatabase().get(index_name));
+  file.addIndex(index);
+  // The entries of one key span more leaves than the BufferPool holds
+  constexpr int n = 30000;
+  for (int i = 0; i < n; i++) {
+    file.insertTuple({{i, "apple", 7}});
+  }
+  auto rids = index.rids(file, 7, 7);
+  ASSERT_EQ(rids.size(), n);
+  file.deleteTuple(rids.back());
+  file.deleteTuple(rids.front());
+  int count = 0;
+  for (const auto &t : file) {
+    EXPECT_NE(std::get<int>(t.get_field(0)), 0);
+    EXPECT_NE(std::get<int>(t.get_field(0)), n - 1);
+    count++;
+  }
+  EXPECT_EQ(count, n - 2);
+  EXPECT_EQ(index.rids(file, 7, 7).size(), n - 2);
+
+  // Every delete seeks to its entry instead of scanning the entries of the key
+  for (size_t i = 1; i < rids.size() - 1; i++) {
+    file.deleteTuple(rids[i]);
+  }
+  EXPECT_EQ(file.begin(), file.end());
+  EXPECT_EQ(index.begin(), index.end());
+}
@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <db/Database.hpp>
+#include <db/Join.hpp>
+#include <db/Query.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+std::vector<db::Tuple> collect(db::op::Operator &op) {
+  std::vector<db::Tuple> tuples;
+  op.open();
+  while (auto t = op.next()) {
+    tuples.push_back(std::move(*t));
+  }
+  op.close();
+  std::sort(tuples.begin(), tuples.end(), [](const db::Tuple &a, const db::Tuple &b) {
+    for (size_t i = 0; i < a.size(); i++) {
+      if (a.get_field(i) != b.get_field(i)) {
+        return a.get_field(i) < b.get_field(i);
+      }
+    }
+    return false;
+  });
+  return tuples;
+}
+
+void expectSame(const std::vector<db::Tuple> &actual, const std::vector<db::Tuple> &expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); i++) {
+    for (size_t j = 0; j < actual[i].size(); j++) {
+      EXPECT_EQ(actual[i].get_field(j), expected[i].get_field(j));
+    }
+  }
+}
+} // namespace
+
+TEST(HashJoinTest, Spill) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"});
+  db::TempFile left("left", td1);
+  db::TempFile right("right", td2);
+  std::mt19937 gen(4646);
+  std::uniform_int_distribution<> dis(0, 3000);
+  for (int i = 0; i < 4000; i++) {
+    left.file().insertTuple({{dis(gen), "left"}});
+    right.file().insertTuple({{dis(gen), i * 0.5}});
+  }
+  // Most tuples share a join value: its partition stays over the budget at every level
+  for (int i = 0; i < 500; i++) {
+    left.file().insertTuple({{7, "skew"}});
+    right.file().insertTuple({{7, -i * 0.5}});
+  }
+  db::JoinPredicate pred{"id", db::PredicateOp::EQ, "id"};
+  auto scans = [&] {
+    return std::make_pair(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()));
+  };
+
+  auto [l1, r1] = scans();
+  db::op::Join join(std::move(l1), std::move(r1), pred);
+  std::vector<db::Tuple> expected = collect(join);
+
+  auto [l2, r2] = scans();
+  db::op::HashJoin small(std::move(l2), std::move(r2), pred, 4 * td2.length());
+  expectSame(collect(small), expected);
+  EXPECT_EQ(small.getStats().depth, db::op::HashJoin::HASH_JOIN_MAX_DEPTH);
+  EXPECT_GT(small.getStats().partitions, db::op::HashJoin::HASH_JOIN_FAN_OUT);
+  EXPECT_GE(small.getStats().spilled_tuples, 9000);
+  EXPECT_GT(small.getStats().spilled_bytes, 0);
+
+  // The join can run again
+  expectSame(collect(small), expected);
+
+  auto [l3, r3] = scans();
+  db::op::HashJoin large(std::move(l3), std::move(r3), pred);
+  expectSame(collect(large), expected);
+  EXPECT_EQ(large.getStats().partitions, 0);
+  EXPECT_EQ(large.getStats().spilled_bytes, 0);
+}
+
+TEST(HashJoinTest, NotEqual) {
+  db::TupleDesc td({db::type_t::INT}, {"id"});
+  db::TempFile file("join", td);
+  auto left = std::make_unique<db::op::Scan>(file.file());
+  auto right = std::make_unique<db::op::Scan>(file.file());
+  db::JoinPredicate pred{"id", db::PredicateOp::LT, "id"};
+  EXPECT_THROW(db::op::HashJoin(std::move(left), std::move(right), pred), std::logic_error);
+}
+
+TEST(HashJoinTest, Radix) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::CHAR, db::type_t::INT}, {"name", "id"});
+  db::TempFile left("left", td1);
+  db::TempFile right("right", td2);
+  std::mt19937 gen(4747);
+  std::uniform_int_distribution<> dis(0, 2000);
+  for (int i = 0; i < 3000; i++) {
+    left.file().insertTuple({{dis(gen), "left"}});
+    right.file().insertTuple({{"right", dis(gen)}});
+  }
+  for (int i = 0; i < 300; i++) {
+    right.file().insertTuple({{"skew", 7}});
+  }
+  left.file().insertTuple({{7, "skew"}});
+  db::JoinPredicate pred{"id", db::PredicateOp::EQ, "id"};
+  auto scans = [&] {
+    return std::make_pair(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()));
+  };
+
+  auto [l1, r1] = scans();
+  db::op::Join join(std::move(l1), std::move(r1), pred);
+  std::vector<db::Tuple> expected = collect(join);
+
+  // A single partition
+  auto [l2, r2] = scans();
+  db::op::RadixJoin single(std::move(l2), std::move(r2), pred, 1);
+  expectSame(collect(single), expected);
+  EXPECT_EQ(single.getBits(), 0);
+
+  // One pass
+  auto [l3, r3] = scans();
+  db::op::RadixJoin one(std::move(l3), std::move(r3), pred, 4, 64);
+  expectSame(collect(one), expected);
+  EXPECT_EQ(one.getBits(), 6);
+
+  // Two passes
+  auto [l4, r4] = scans();
+  db::op::RadixJoin two(std::move(l4), std::move(r4), pred, 4, 1);
+  expectSame(collect(two), expected);
+  EXPECT_EQ(two.getBits(), 11);
+  expectSame(collect(two), expected);
+}
+
+TEST(MergeJoinTest, Sorted) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::DOUBLE, db::type_t::INT}, {"price", "id"});
+  db::TempFile left("left", td1);
+  db::TempFile right("right", td2);
+  std::mt19937 gen(4848);
+  std::uniform_int_distribution<> dis(0, 100);
+  // Runs of duplicates on both sides
+  for (int i = 0; i < 400; i++) {
+    left.file().insertTuple({{dis(gen), "left"}});
+    right.file().insertTuple({{i * 0.5, dis(gen) + 20}});
+  }
+  db::TempFile sorted_left("left", td1);
+  db::TempFile sorted_right("right", td2);
+  db::sort(left.file(), sorted_left.file(), "id");
+  db::sort(right.file(), sorted_right.file(), "id");
+
+  for (auto op : {db::PredicateOp::EQ, db::PredicateOp::LT, db::PredicateOp::LE, db::PredicateOp::GT,
+                  db::PredicateOp::GE}) {
+    db::JoinPredicate pred{"id", op, "id"};
+    db::op::Join join(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()), pred);
+    db::op::MergeJoin merge(std::make_unique<db::op::Scan>(sorted_left.file()),
+                            std::make_unique<db::op::Scan>(sorted_right.file()), pred);
+    std::vector<db::Tuple> expected = collect(join);
+    EXPECT_FALSE(expected.empty());
+    expectSame(collect(merge), expected);
+  }
+
+  db::JoinPredicate pred{"id", db::PredicateOp::NE, "id"};
+  EXPECT_THROW(db::op::MergeJoin(std::make_unique<db::op::Scan>(sorted_left.file()),
+                                 std::make_unique<db::op::Scan>(sorted_right.file()), pred),
+               std::logic_error);
+}
+
+TEST(IndexJoinTest, Lookup) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::DOUBLE, db::type_t::INT}, {"price", "id"});
+  db::TempFile left("left", td1);
+  const char *name = "index_join.db";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td2, 1, false));
+  const auto &tree = dynamic_cast<const db::BTreeFile &>(db::getDatabase().get(name));
+  std::mt19937 gen(4949);
+  std::uniform_int_distribution<> dis(0, 1000);
+  for (int i = 0; i < 3000; i++) {
+    db::getDatabase().get(name).insertTuple({{i * 0.5, dis(gen)}});
+  }
+  // Left values that repeat, and values that are not in the tree
+  for (int i = 0; i < 700; i++) {
+    left.file().insertTuple({{dis(gen) * 2 - 500, "left"}});
+  }
+  db::JoinPredicate pred{"id", db::PredicateOp::EQ, "id"};
+
+  db::op::Join join(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(tree), pred);
+  std::vector<db::Tuple> expected = collect(join);
+  EXPECT_FALSE(expected.empty());
+  for (size_t batch : {size_t{1}, size_t{100}, db::op::IndexJoin::INDEX_JOIN_BATCH}) {
+    db::op::IndexJoin index_join(std::make_unique<db::op::Scan>(left.file()), tree, pred, batch);
+    expectSame(collect(index_join), expected);
+  }
+
+  db::JoinPredicate price{"id", db::PredicateOp::EQ, "price"};
+  EXPECT_THROW(db::op::IndexJoin(std::make_unique<db::op::Scan>(left.file()), tree, price), std::logic_error);
+  db::getDatabase().remove(name);
+  std::remove(name);
+}
+
+TEST(BlockJoinTest, Blocks) {
+  db::TupleDesc td1({db::type_t::DOUBLE, db::type_t::CHAR}, {"price", "name"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"});
+  db::TempFile left("left", td1);
+  db::TempFile right("right", td2);
+  std::mt19937 gen(5050);
+  std::uniform_int_distribution<> dis(0, 20);
+  for (int i = 0; i < 2500; i++) {
+    left.file().insertTuple({{dis(gen) * 0.5, "left"}});
+  }
+  for (int i = 0; i < 20; i++) {
+    right.file().insertTuple({{i, dis(gen) * 0.5}});
+  }
+
+  for (auto op : {db::PredicateOp::EQ, db::PredicateOp::NE, db::PredicateOp::LT, db::PredicateOp::LE,
+                  db::PredicateOp::GT, db::PredicateOp::GE}) {
+    db::JoinPredicate pred{"price", op, "price"};
+    db::op::Join join(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()), pred);
+    std::vector<db::Tuple> expected = collect(join);
+    EXPECT_FALSE(expected.empty());
+
+    // Blocks of 1000 tuples, in columns of BATCH_SIZE values and a partial column
+    db::op::BlockJoin small(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()),
+                            pred, 1000 * td1.length());
+    expectSame(collect(small), expected);
+    EXPECT_EQ(small.getBlocks(), 3);
+
+    db::op::BlockJoin large(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()),
+                            pred, 1 << 20);
+    expectSame(collect(large), expected);
+    EXPECT_EQ(large.getBlocks(), 1);
+  }
+
+  // A value of another type compares by type
+  db::JoinPredicate mixed{"price", db::PredicateOp::LT, "id"};
+  db::op::Join join(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()), mixed);
+  db::op::BlockJoin block(std::make_unique<db::op::Scan>(left.file()), std::make_unique<db::op::Scan>(right.file()),
+                          mixed);
+  expectSame(collect(block), collect(join));
+}
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <db/BTreeFile.hpp>
 #include <db/Database.hpp>
 #include <db/HeapFile.hpp>
+#include <db/Join.hpp>
 #include <db/Query.hpp>
 #include <gtest/gtest.h>
 #include <random>
@@ -157,3 +160,142 @@ TEST(JoinTest, Large) {
   }
   EXPECT_EQ(i, expected);
 }
+
+TEST(JoinTest, BTree) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::INT}, {"quantity", "id"});
+  db::TupleDesc td3({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "quantity"});
+  db::TupleDesc td4({db::type_t::INT, db::type_t::CHAR, db::type_t::INT, db::type_t::INT},
+                    {"id1", "name", "quantity", "id2"});
+
+  const char *left_name = "left.in";
+  const char *right_name = "right.in";
+  const char *eq_name = "eq.out";
+  const char *gt_name = "gt.out";
+  for (const char *name : {left_name, right_name, eq_name, gt_name}) {
+    std::remove(name);
+  }
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(left_name, td1, 0, false));
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(right_name, td2, 1, false));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(eq_name, td3));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(gt_name, td4));
+  auto &left = db::getDatabase().get(left_name);
+  auto &right = db::getDatabase().get(right_name);
+
+  std::mt19937 gen(4848);
+  std::uniform_int_distribution<> dis(0, 200);
+  std::vector<int> left_ids;
+  std::vector<int> right_ids;
+  for (int i = 0; i < 600; i++) {
+    left_ids.push_back(dis(gen));
+    right_ids.push_back(dis(gen));
+    left.insertTuple({{left_ids.back(), "Hello"}});
+    right.insertTuple({{i, right_ids.back()}});
+  }
+  size_t eq = 0;
+  size_t gt = 0;
+  for (int l : left_ids) {
+    for (int r : right_ids) {
+      eq += l == r;
+      gt += l > r;
+    }
+  }
+
+  auto count = [](const db::DbFile &file) {
+    size_t n = 0;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+      n++;
+    }
+    return n;
+  };
+  db::join(left, right, db::getDatabase().get(eq_name), {"id", db::PredicateOp::EQ, "id"});
+  EXPECT_EQ(count(db::getDatabase().get(eq_name)), eq);
+  db::join(left, right, db::getDatabase().get(gt_name), {"id", db::PredicateOp::GT, "id"});
+  EXPECT_EQ(count(db::getDatabase().get(gt_name)), gt);
+}
+
+TEST(JoinTest, Spill) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::INT}, {"quantity", "id"});
+  db::TupleDesc td3({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "quantity"});
+
+  const char *left_name = "left.in";
+  const char *right_name = "right.in";
+  const char *out_name = "heapfile.out";
+  std::remove(left_name);
+  std::remove(right_name);
+  std::remove(out_name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(left_name, td1));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(right_name, td2));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td3));
+  auto &left = db::getDatabase().get(left_name);
+  auto &right = db::getDatabase().get(right_name);
+  auto &out = db::getDatabase().get(out_name);
+
+  // The right table is larger than the memory budget of a join, so its partitions are written to temporary files
+  std::mt19937 gen(4646);
+  std::uniform_int_distribution<> dis(0, 5000);
+  std::unordered_map<int, size_t> right_ids;
+  for (int i = 0; i < 20000; i++) {
+    int id = dis(gen);
+    right.insertTuple({{i, id}});
+    right_ids[id]++;
+  }
+  ASSERT_GT(right.getNumPages() * db::DEFAULT_PAGE_SIZE, db::op::DEFAULT_JOIN_MEMORY);
+  size_t expected = 0;
+  for (int i = 0; i < 2000; i++) {
+    int id = dis(gen);
+    left.insertTuple({{id, "Hello"}});
+    expected += right_ids[id];
+  }
+
+  db::join(left, right, out, {"id", db::PredicateOp::EQ, "id"});
+  size_t count = 0;
+  for (auto it = out.begin(); it != out.end(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(count, expected);
+}
+
+TEST(JoinTest, LargeOrder) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR}, {"id", "name"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::INT}, {"quantity", "id"});
+  db::TupleDesc td3({db::type_t::INT, db::type_t::CHAR, db::type_t::INT, db::type_t::INT},
+                    {"id1", "name", "quantity", "id2"});
+
+  const char *left_name = "left.in";
+  const char *right_name = "right.in";
+  const char *out_name = "heapfile.out";
+  std::remove(left_name);
+  std::remove(right_name);
+  std::remove(out_name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(left_name, td1));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(right_name, td2));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td3));
+  auto &left = db::getDatabase().get(left_name);
+  auto &right = db::getDatabase().get(right_name);
+  auto &out = db::getDatabase().get(out_name);
+
+  // The right table is larger than the memory budget of a join, so it is not held in memory by a merge join
+  std::mt19937 gen(4848);
+  std::uniform_int_distribution<> dis(0, 100000);
+  std::vector<int> right_ids;
+  for (int i = 0; i < 20000; i++) {
+    right_ids.push_back(dis(gen));
+    right.insertTuple({{i, right_ids.back()}});
+  }
+  ASSERT_GT(right.getNumPages() * db::DEFAULT_PAGE_SIZE, db::op::DEFAULT_JOIN_MEMORY);
+  size_t expected = 0;
+  for (int i = 0; i < 50; i++) {
+    int id = dis(gen) / 100;
+    left.insertTuple({{id, "Hello"}});
+    expected += std::count_if(right_ids.begin(), right_ids.end(), [&](int r) { return id > r; });
+  }
+
+  db::join(left, right, out, {"id", db::PredicateOp::GT, "id"});
+  size_t count = 0;
+  for (auto it = out.begin(); it != out.end(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(count, expected);
+}
@@ -0,0 +1,89 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Operator.hpp>
+#include <gtest/gtest.h>
+#include <map>
+
+TEST(OperatorTest, Pipeline) {
+  db::TupleDesc td1({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::TupleDesc td2({db::type_t::INT, db::type_t::INT}, {"quantity", "id"});
+  db::TupleDesc td3({db::type_t::CHAR, db::type_t::INT}, {"name", "total"});
+
+  const char *left_name = "left.in";
+  const char *right_name = "right.in";
+  const char *out_name = "heapfile.out";
+  std::remove(left_name);
+  std::remove(right_name);
+  std::remove(out_name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(left_name, td1));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(right_name, td2));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td3));
+  auto &left = db::getDatabase().get(left_name);
+  auto &right = db::getDatabase().get(right_name);
+  auto &out = db::getDatabase().get(out_name);
+
+  const char *names[] = {"apple", "banana", "cherry"};
+  for (int i = 0; i < 3000; i++) {
+    left.insertTuple({{i, names[i % 3], i * 0.5}});
+    right.insertTuple({{i % 7, i}});
+  }
+  std::map<std::string, int> expected;
+  for (int i = 0; i < 3000; i++) {
+    if (i * 0.5 < 1000) {
+      expected[names[i % 3]] += i % 7;
+    }
+  }
+
+  // SELECT name, SUM(quantity) FROM left JOIN right USING (id) WHERE price < 1000 GROUP BY name
+  std::unique_ptr<db::op::Operator> plan = std::make_unique<db::op::Filter>(
+      std::make_unique<db::op::Scan>(left), std::vector<db::FilterPredicate>{{"price", db::PredicateOp::LT, 1000.0}});
+  plan = std::make_unique<db::op::Join>(std::move(plan), std::make_unique<db::op::Scan>(right),
+                                        db::JoinPredicate{"id", db::PredicateOp::EQ, "id"});
+  plan = std::make_unique<db::op::Project>(std::move(plan), std::vector<std::string>{"name", "quantity"});
+  EXPECT_EQ(plan->getTupleDesc().size(), 2);
+  plan = std::make_unique<db::op::Aggregate>(std::move(plan),
+                                             db::Aggregate{"name", db::AggregateOp::SUM, "quantity"});
+
+  // Only the output file is written
+  db::getDatabase().getBufferPool().flushFile(left_name);
+  db::getDatabase().getBufferPool().flushFile(right_name);
+  size_t left_writes = left.getWrites().size();
+  size_t right_writes = right.getWrites().size();
+  EXPECT_EQ(db::op::Sink(std::move(plan), out).run(), 3);
+  EXPECT_EQ(left.getWrites().size(), left_writes);
+  EXPECT_EQ(right.getWrites().size(), right_writes);
+
+  std::map<std::string, int> totals;
+  for (const auto &t : out) {
+    totals[std::get<std::string>(t.get_field(0))] = std::get<int>(t.get_field(1));
+  }
+  EXPECT_EQ(totals, expected);
+}
+
+TEST(OperatorTest, Reopen) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::INT}, {"id", "value"});
+  const char *name = "heapfile.in";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &in = db::getDatabase().get(name);
+  for (int i = 0; i < 100; i++) {
+    in.insertTuple({{i, i % 10}});
+  }
+
+  // A non-equality join reads its right child again for every left tuple
+  db::op::Join join(std::make_unique<db::op::Filter>(std::make_unique<db::op::Scan>(in),
+                                                     std::vector<db::FilterPredicate>{{"id", db::PredicateOp::LT, 5}}),
+                    std::make_unique<db::op::Scan>(in), {"id", db::PredicateOp::GT, "value"});
+  EXPECT_EQ(join.getTupleDesc().name_of(2), "id.1");
+  for (int round = 0; round < 2; round++) {
+    join.open();
+    size_t count = 0;
+    while (auto t = join.next()) {
+      EXPECT_GT(t->get_field(0), t->get_field(3));
+      count++;
+    }
+    join.close();
+    // Each left id matches the 10 right tuples of every smaller value
+    EXPECT_EQ(count, 10 * (0 + 1 + 2 + 3 + 4));
+  }
+}
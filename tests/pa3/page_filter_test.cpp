@@ -0,0 +1,91 @@
+#include <cmath>
+#include <db/HeapPage.hpp>
+#include <db/PageFilter.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+bool test(const db::field_t &lhs, db::PredicateOp op, const db::field_t &rhs) {
+  switch (op) {
+  case db::PredicateOp::EQ:
+    return lhs == rhs;
+  case db::PredicateOp::NE:
+    return lhs != rhs;
+  case db::PredicateOp::LT:
+    return lhs < rhs;
+  case db::PredicateOp::LE:
+    return lhs <= rhs;
+  case db::PredicateOp::GT:
+    return lhs > rhs;
+  case db::PredicateOp::GE:
+    return lhs >= rhs;
+  }
+  return false;
+}
+} // namespace
+
+TEST(PageFilterTest, Select) {
+  struct Row {
+    double price;
+    int id;
+    char name[20];
+  };
+  const db::PredicateOp ops[] = {db::PredicateOp::EQ, db::PredicateOp::NE, db::PredicateOp::LT,
+                                 db::PredicateOp::LE, db::PredicateOp::GT, db::PredicateOp::GE};
+  std::mt19937 gen(660);
+  std::uniform_int_distribution<> dis(-5, 5);
+  for (size_t n : {0, 1, 7, 63, 64, 65, 130, 200}) {
+    std::vector<Row> rows(n);
+    for (auto &row : rows) {
+      row.id = dis(gen);
+      row.price = dis(gen) == 0 ? NAN : dis(gen) * 0.5;
+    }
+    // Every other slot of the first words, and every slot after them
+    std::vector<uint64_t> occupied(db::pagefilter::words(n));
+    for (size_t i = 0; i < n; i++) {
+      if (i >= 96 || i % 2 == 0) {
+        occupied[i / 64] |= uint64_t{1} << i % 64;
+      }
+    }
+    const auto *base = reinterpret_cast<const uint8_t *>(rows.data());
+    for (auto op : ops) {
+      for (int value : {-6, -1, 0, 3, 6}) {
+        std::vector<uint64_t> ids = occupied;
+        std::vector<uint64_t> prices = occupied;
+        size_t id_count =
+            db::pagefilter::select(base + offsetof(Row, id), sizeof(Row), n, op, value, ids.data());
+        size_t price_count =
+            db::pagefilter::select(base + offsetof(Row, price), sizeof(Row), n, op, value * 0.5, prices.data());
+        size_t expected_ids = 0;
+        size_t expected_prices = 0;
+        for (size_t i = 0; i < n; i++) {
+          bool slot = occupied[i / 64] >> i % 64 & 1;
+          bool id = slot && test(rows[i].id, op, value);
+          bool price = slot && test(rows[i].price, op, value * 0.5);
+          EXPECT_EQ(ids[i / 64] >> i % 64 & 1, id);
+          EXPECT_EQ(prices[i / 64] >> i % 64 & 1, price);
+          expected_ids += id;
+          expected_prices += price;
+        }
+        EXPECT_EQ(id_count, expected_ids);
+        EXPECT_EQ(price_count, expected_prices);
+      }
+    }
+  }
+}
+
+TEST(PageFilterTest, Occupied) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"});
+  db::Page page{};
+  db::HeapPage hp(page, td);
+  while (hp.insertTuple({{1, 2.0}})) {
+  }
+  for (size_t slot = 0; slot < hp.end(); slot += 3) {
+    hp.deleteTuple(slot);
+  }
+  std::vector<uint64_t> bits(db::pagefilter::words(hp.end()));
+  hp.occupied(bits.data());
+  for (size_t slot = 0; slot < bits.size() * 64; slot++) {
+    EXPECT_EQ(bits[slot / 64] >> slot % 64 & 1, slot < hp.end() && !hp.empty(slot));
+  }
+}
@@ -0,0 +1,98 @@
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Vector.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+std::vector<std::vector<db::field_t>> collect(db::op::Operator &op) {
+  std::vector<std::vector<db::field_t>> rows;
+  op.open();
+  while (auto t = op.next()) {
+    std::vector<db::field_t> row;
+    for (size_t i = 0; i < t->size(); i++) {
+      row.push_back(t->get_field(i));
+    }
+    rows.push_back(row);
+  }
+  op.close();
+  return rows;
+}
+} // namespace
+
+TEST(VectorTest, SameAsRows) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  const char *name = "heapfile.in";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &in = db::getDatabase().get(name);
+
+  const char *names[] = {"apple", "banana", "cherry", "date"};
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<> dis(-1000, 1000);
+  for (int i = 0; i < 5000; i++) {
+    in.insertTuple({{dis(gen), names[i % 4], dis(gen) * 0.25}});
+  }
+  // Leave holes in the pages, so that batches span pages with empty slots
+  for (auto it = in.begin(); it != in.end(); ++it) {
+    if (it.slot % 3 == 0) {
+      in.deleteTuple(it);
+    }
+  }
+
+  std::vector<std::vector<db::FilterPredicate>> filters = {
+      {},
+      {{"id", db::PredicateOp::EQ, 7}},
+      {{"id", db::PredicateOp::NE, 7}},
+      {{"id", db::PredicateOp::LT, 0}, {"price", db::PredicateOp::GE, -100.0}},
+      {{"id", db::PredicateOp::LE, 500}, {"id", db::PredicateOp::GT, -500}, {"name", db::PredicateOp::NE, "date"}},
+      // A value of another type compares by type, like field_t does
+      {{"id", db::PredicateOp::LT, 1.5}},
+      {{"price", db::PredicateOp::LT, 1}},
+  };
+  for (const auto &pred : filters) {
+    db::op::Filter rows(std::make_unique<db::op::Scan>(in, std::vector<std::string>{"price", "name", "id"}), pred);
+    db::vec::Rows vectors(std::make_unique<db::vec::Filter>(
+        std::make_unique<db::vec::Scan>(in, std::vector<std::string>{"price", "name", "id"}), pred));
+    EXPECT_EQ(collect(vectors), collect(rows));
+  }
+
+  db::op::Project rows(std::make_unique<db::op::Scan>(in), {"name", "id", "name"});
+  db::vec::Rows vectors(std::make_unique<db::vec::Project>(std::make_unique<db::vec::Scan>(in),
+                                                           std::vector<std::string>{"name", "id", "name"}));
+  EXPECT_EQ(vectors.getTupleDesc().name_of(2), "name.1");
+  EXPECT_EQ(collect(vectors), collect(rows));
+
+  std::vector<db::FilterPredicate> pred{{"id", db::PredicateOp::GE, 0}};
+  for (auto op : {db::AggregateOp::SUM, db::AggregateOp::AVG, db::AggregateOp::MIN, db::AggregateOp::MAX,
+                  db::AggregateOp::COUNT}) {
+    for (const char *field : {"id", "price", "name"}) {
+      if (field == std::string("name") && (op == db::AggregateOp::SUM || op == db::AggregateOp::AVG)) {
+        continue;
+      }
+      for (std::optional<std::string> group : {std::optional<std::string>(), std::optional<std::string>("name"),
+                                               std::optional<std::string>("id")}) {
+        db::Aggregate agg{group, op, field};
+        db::op::Aggregate rows(std::make_unique<db::op::Filter>(std::make_unique<db::op::Scan>(in), pred), agg);
+        db::vec::Rows vectors(std::make_unique<db::vec::Aggregate>(
+            std::make_unique<db::vec::Filter>(std::make_unique<db::vec::Scan>(in), pred), agg));
+        EXPECT_EQ(vectors.getTupleDesc().name_of(group ? 1 : 0), rows.getTupleDesc().name_of(group ? 1 : 0));
+        EXPECT_EQ(collect(vectors), collect(rows));
+      }
+    }
+  }
+
+  // COUNT of no rows is a single 0, and the other aggregates produce nothing
+  std::vector<db::FilterPredicate> none{{"id", db::PredicateOp::GT, 1000}};
+  db::vec::Rows count(std::make_unique<db::vec::Aggregate>(
+      std::make_unique<db::vec::Filter>(std::make_unique<db::vec::Scan>(in), none),
+      db::Aggregate{std::nullopt, db::AggregateOp::COUNT, "id"}));
+  EXPECT_EQ(collect(count), std::vector<std::vector<db::field_t>>{{0}});
+  db::vec::Rows sum(std::make_unique<db::vec::Aggregate>(
+      std::make_unique<db::vec::Filter>(std::make_unique<db::vec::Scan>(in), none),
+      db::Aggregate{std::nullopt, db::AggregateOp::SUM, "id"}));
+  EXPECT_TRUE(collect(sum).empty());
+
+  db::vec::Aggregate bad(std::make_unique<db::vec::Scan>(in), {std::nullopt, db::AggregateOp::SUM, "name"});
+  EXPECT_THROW(bad.open(), std::logic_error);
+}
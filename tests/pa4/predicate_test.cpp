@@ -0,0 +1,67 @@
+#include <db/Predicate.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(PredicateTest, Evaluate) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  const char *names[] = {"apple", "banana", "cherry"};
+  std::mt19937 gen(660);
+  std::uniform_int_distribution<> dis(-10, 10);
+  std::vector<db::Tuple> tuples;
+  for (int i = 0; i < 300; i++) {
+    tuples.push_back({{dis(gen), names[i % 3], dis(gen) * 0.5}});
+  }
+  const db::PredicateOp ops[] = {db::PredicateOp::EQ, db::PredicateOp::NE, db::PredicateOp::LT,
+                                 db::PredicateOp::LE, db::PredicateOp::GT, db::PredicateOp::GE};
+  std::vector<uint8_t> data(td.length());
+  for (auto op : ops) {
+    std::vector<std::vector<db::FilterPredicate>> preds = {
+        {},
+        {{"id", op, 3}},
+        {{"price", op, -1.5}, {"id", db::PredicateOp::NE, 0}},
+        {{"name", op, "banana"}, {"id", op, -2}, {"price", db::PredicateOp::LT, 4.0}},
+        // Values of another type compare by type
+        {{"id", op, 2.5}},
+        {{"name", op, 1}, {"price", db::PredicateOp::GE, 0.0}},
+    };
+    for (const auto &pred : preds) {
+      db::CompiledPredicate short_circuit(td, pred);
+      db::CompiledPredicate branch_free(td, pred, db::EvalMode::BRANCH_FREE);
+      for (const auto &t : tuples) {
+        bool expected = true;
+        for (const auto &p : pred) {
+          expected = expected && db::compare(t.get_field(td.index_of(p.field_name)), p.op, p.value);
+        }
+        td.serialize(data.data(), t);
+        EXPECT_EQ(short_circuit(t), expected);
+        EXPECT_EQ(short_circuit(data.data()), expected);
+        EXPECT_EQ(branch_free(t), expected);
+        EXPECT_EQ(branch_free(data.data()), expected);
+      }
+    }
+  }
+}
+
+TEST(PredicateTest, Order) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::INT}, {"id", "name", "age"});
+  db::CompiledPredicate::Stats stats;
+  stats.emplace("id", db::ColumnStats(100, 0, 999));
+  stats.emplace("age", db::ColumnStats(10, 0, 99));
+  for (int i = 0; i < 1000; i++) {
+    stats.at("id").addValue(i);
+    stats.at("age").addValue(i % 100);
+  }
+  std::vector<db::FilterPredicate> pred{
+      {"age", db::PredicateOp::LT, 90},   // keeps 90%
+      {"name", db::PredicateOp::EQ, "x"}, // no histogram, keeps 10%
+      {"id", db::PredicateOp::LT, 10},    // keeps 1%
+      {"id", db::PredicateOp::EQ, 2.5},   // always false for an INT field: not evaluated
+  };
+  db::CompiledPredicate compiled(td, pred, db::EvalMode::SHORT_CIRCUIT, stats);
+  EXPECT_EQ(compiled.getOrder(), (std::vector<size_t>{2, 1, 0}));
+  EXPECT_FALSE(compiled(db::Tuple({5, "x", 1})));
+
+  // Without histograms, an INT equality is cheaper than a CHAR equality that rejects as many tuples
+  db::CompiledPredicate plain(td, {pred[1], {"age", db::PredicateOp::EQ, 5}});
+  EXPECT_EQ(plain.getOrder(), (std::vector<size_t>{1, 0}));
+}